@@ -2,4 +2,4 @@
 
 set -xe
 
-g++ -std=c++17 -g -Wall -Wextra -O3 -o main src/* -Iinclude -lm
+g++ -std=c++20 -g -Wall -Wextra -O3 -o main src/* -Iinclude -lm -pthread
@@ -0,0 +1,390 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "column.hpp"
+
+// Structures of the Arrow C Data Interface, as given by its specification:
+// https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace df {
+namespace impl {
+/**
+ * @brief Returns the Arrow format string of a column of @T. String columns
+ * use 32-bit offsets unless @large is set.
+ */
+template <typename T>
+constexpr auto ArrowFormat(bool large = false) noexcept -> char const* {
+  if constexpr (IsString<T>) {
+    return large ? "U" : "u";
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return "b";
+  } else if constexpr (std::is_same_v<T, float>) {
+    return "f";
+  } else if constexpr (std::is_same_v<T, double>) {
+    return "g";
+  } else {
+    static_assert(std::is_integral_v<T> && sizeof(T) <= 8,
+                  "Arrow columns hold integers, float, double, bool and "
+                  "std::string");
+    constexpr bool Signed = std::is_signed_v<T>;
+    switch (sizeof(T)) {
+      case 1:
+        return Signed ? "c" : "C";
+      case 2:
+        return Signed ? "s" : "S";
+      case 4:
+        return Signed ? "i" : "I";
+      default:
+        return Signed ? "l" : "L";
+    }
+  }
+}
+
+/**
+ * @brief Owns the memory of an exported struct array: the columns, the
+ * buffers converted to the Arrow layout, and the child structures.
+ *
+ * Every exported ArrowArray holds a reference to it, so children moved out
+ * by the consumer keep their buffers alive after the parent is released.
+ */
+template <typename... Ts>
+struct ArrowArrayHolder {
+  static constexpr std::size_t NumCols = sizeof...(Ts);
+
+  std::tuple<Column<Ts>...> columns;
+  // Converted buffers of string and bool columns.
+  std::vector<std::vector<std::byte>> converted;
+  std::vector<void const*> buffers[NumCols + 1];
+  ArrowArray childArrays[NumCols];
+  ArrowArray* children[NumCols];
+};
+
+/**
+ * @brief Owns the memory of an exported struct schema.
+ */
+struct ArrowSchemaHolder {
+  std::vector<std::string> names;
+  std::vector<ArrowSchema> childSchemas;
+  std::vector<ArrowSchema*> children;
+};
+
+template <typename Holder>
+auto ReleaseArrow(ArrowArray* array) noexcept -> void {
+  for (std::int64_t i = 0; i < array->n_children; ++i) {
+    if (array->children[i]->release != nullptr) {
+      array->children[i]->release(array->children[i]);
+    }
+  }
+  delete static_cast<std::shared_ptr<Holder>*>(array->private_data);
+  array->release = nullptr;
+}
+
+template <typename Holder>
+auto ReleaseArrow(ArrowSchema* schema) noexcept -> void {
+  for (std::int64_t i = 0; i < schema->n_children; ++i) {
+    if (schema->children[i]->release != nullptr) {
+      schema->children[i]->release(schema->children[i]);
+    }
+  }
+  delete static_cast<std::shared_ptr<Holder>*>(schema->private_data);
+  schema->release = nullptr;
+}
+
+/**
+ * @brief Fill in the buffers of a column in the Arrow layout. Fixed-width
+ * columns are shared by pointer; string and bool columns are converted.
+ */
+template <typename T>
+auto ExportArrowBuffers(Column<T> const& column,
+                        std::vector<std::vector<std::byte>>& converted,
+                        std::vector<void const*>& buffers) -> bool {
+  buffers.push_back(nullptr);  // no validity bitmap
+  if constexpr (IsString<T>) {
+    std::size_t numBytes = 0;
+    for (auto const& s : column) {
+      numBytes += s.size();
+    }
+    bool const large = numBytes > std::numeric_limits<std::int32_t>::max();
+    auto writeOffsets = [&]<typename Offset>(Offset) {
+      auto& offsets = converted.emplace_back((column.size() + 1) *
+                                             sizeof(Offset));
+      auto* out = reinterpret_cast<Offset*>(offsets.data());
+      Offset offset = 0;
+      *out++ = offset;
+      for (auto const& s : column) {
+        offset += static_cast<Offset>(s.size());
+        *out++ = offset;
+      }
+      buffers.push_back(offsets.data());
+    };
+    if (large) {
+      writeOffsets(std::int64_t{});
+    } else {
+      writeOffsets(std::int32_t{});
+    }
+    auto& bytes = converted.emplace_back(numBytes);
+    std::byte* out = bytes.data();
+    for (auto const& s : column) {
+      std::memcpy(out, s.data(), s.size());
+      out += s.size();
+    }
+    buffers.push_back(bytes.data());
+    return large;
+  } else if constexpr (std::is_same_v<T, bool>) {
+    auto& bits = converted.emplace_back((column.size() + 7) / 8);
+    for (std::size_t i = 0; i < column.size(); ++i) {
+      bits[i / 8] |= std::byte(column[i]) << (i % 8);
+    }
+    buffers.push_back(bits.data());
+    return false;
+  } else {
+    buffers.push_back(column.data());
+    return false;
+  }
+}
+
+/**
+ * @brief Export @columns as an Arrow struct array whose children are the
+ * columns, named after their index.
+ *
+ * @param columns The columns of the DF. Moved into the exported array.
+ * @param schema Receives the schema of the array.
+ * @param array Receives the array.
+ */
+template <typename... Ts, std::size_t... Is>
+auto ExportArrow(std::tuple<Column<Ts>...>&& columns, ArrowSchema* schema,
+                 ArrowArray* array, std::index_sequence<Is...>) -> void {
+  constexpr std::size_t NumCols = sizeof...(Ts);
+  using ArrayHolder = ArrowArrayHolder<Ts...>;
+  // Move-construct the columns, which keeps their memory resource.
+  auto holder = std::make_shared<ArrayHolder>(std::move(columns));
+  std::int64_t const length = std::get<0>(holder->columns).size();
+  bool const large[] = {ExportArrowBuffers(std::get<Is>(holder->columns),
+                                           holder->converted,
+                                           holder->buffers[Is])...};
+  holder->buffers[NumCols].push_back(nullptr);
+  for (std::size_t i = 0; i < NumCols; ++i) {
+    holder->childArrays[i] = ArrowArray{
+        length,
+        0,
+        0,
+        static_cast<std::int64_t>(holder->buffers[i].size()),
+        0,
+        holder->buffers[i].data(),
+        nullptr,
+        nullptr,
+        &ReleaseArrow<ArrayHolder>,
+        new std::shared_ptr<ArrayHolder>(holder)};
+    holder->children[i] = &holder->childArrays[i];
+  }
+  *array = ArrowArray{length,
+                      0,
+                      0,
+                      1,
+                      NumCols,
+                      holder->buffers[NumCols].data(),
+                      holder->children,
+                      nullptr,
+                      &ReleaseArrow<ArrayHolder>,
+                      new std::shared_ptr<ArrayHolder>(holder)};
+
+  auto schemaHolder = std::make_shared<ArrowSchemaHolder>();
+  char const* const formats[] = {ArrowFormat<Ts>(large[Is])...};
+  schemaHolder->names.reserve(NumCols);
+  schemaHolder->childSchemas.reserve(NumCols);
+  for (std::size_t i = 0; i < NumCols; ++i) {
+    schemaHolder->names.push_back(std::to_string(i));
+    schemaHolder->childSchemas.push_back(
+        ArrowSchema{formats[i], schemaHolder->names.back().c_str(), nullptr,
+                    0, 0, nullptr, nullptr, &ReleaseArrow<ArrowSchemaHolder>,
+                    new std::shared_ptr<ArrowSchemaHolder>(schemaHolder)});
+    schemaHolder->children.push_back(&schemaHolder->childSchemas.back());
+  }
+  *schema = ArrowSchema{"+s",
+                        "",
+                        nullptr,
+                        0,
+                        NumCols,
+                        schemaHolder->children.data(),
+                        nullptr,
+                        &ReleaseArrow<ArrowSchemaHolder>,
+                        new std::shared_ptr<ArrowSchemaHolder>(schemaHolder)};
+}
+
+/**
+ * @brief Returns whether the validity bitmap of @array marks any value of
+ * [@offset, @offset + @length) as null.
+ */
+inline auto HasArrowNulls(ArrowArray const& array, std::int64_t offset,
+                          std::int64_t length) noexcept -> bool {
+  if (array.null_count == 0 || array.n_buffers == 0 ||
+      array.buffers[0] == nullptr) {
+    return false;
+  }
+  auto const* validity = static_cast<std::uint8_t const*>(array.buffers[0]);
+  for (std::int64_t i = offset; i < offset + length; ++i) {
+    if (((validity[i / 8] >> (i % 8)) & 1) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Append the values of the Arrow child array @array to @column.
+ *
+ * @param schema Schema of the child array.
+ * @param array The child array.
+ * @param offset Offset of the first value, including the parent's offset.
+ * @param length Number of values.
+ * @param column The column to append to.
+ * @throws std::invalid_argument if the array does not match the column type
+ * or holds nulls.
+ */
+template <typename T>
+auto ImportArrowColumn(ArrowSchema const& schema, ArrowArray const& array,
+                       std::int64_t offset, std::int64_t length,
+                       Column<T>& column) -> void {
+  std::string_view const format{schema.format};
+  bool const large = format == "U";
+  if (format != ArrowFormat<T>(large)) {
+    throw std::invalid_argument("Arrow column of format " +
+                                std::string{format} + " does not match " +
+                                ArrowFormat<T>(large));
+  }
+  if (HasArrowNulls(array, offset, length)) {
+    throw std::invalid_argument("Arrow column holds null values");
+  }
+  column.reserve(column.size() + length);
+  if constexpr (IsString<T>) {
+    auto const* bytes = static_cast<char const*>(array.buffers[2]);
+    auto readStrings = [&]<typename Offset>(Offset const* offsets) {
+      for (std::int64_t i = offset; i < offset + length; ++i) {
+        column.emplace_back(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+      }
+    };
+    if (large) {
+      readStrings(static_cast<std::int64_t const*>(array.buffers[1]));
+    } else {
+      readStrings(static_cast<std::int32_t const*>(array.buffers[1]));
+    }
+  } else if constexpr (std::is_same_v<T, bool>) {
+    auto const* bits = static_cast<std::uint8_t const*>(array.buffers[1]);
+    for (std::int64_t i = offset; i < offset + length; ++i) {
+      column.push_back((bits[i / 8] >> (i % 8)) & 1);
+    }
+  } else {
+    auto const* values = static_cast<T const*>(array.buffers[1]) + offset;
+    column.insert(column.end(), values, values + length);
+  }
+}
+
+/**
+ * @brief Append the rows of an Arrow struct array to @columns, then release
+ * @schema and @array, even if an exception is thrown.
+ *
+ * @param schema Schema of a struct array with one child per column.
+ * @param array The struct array.
+ * @param columns The columns of the DF.
+ * @throws std::invalid_argument if the array does not match the columns.
+ */
+template <typename... Ts, std::size_t... Is>
+auto ImportArrow(ArrowSchema* schema, ArrowArray* array,
+                 std::tuple<Column<Ts>...>& columns,
+                 std::index_sequence<Is...>) -> void {
+  struct Releaser {
+    ArrowSchema* schema;
+    ArrowArray* array;
+    ~Releaser() {
+      if (array->release != nullptr) {
+        array->release(array);
+      }
+      if (schema->release != nullptr) {
+        schema->release(schema);
+      }
+    }
+  } releaser{schema, array};
+
+  if (std::string_view{schema->format} != "+s" ||
+      schema->n_children != sizeof...(Ts) ||
+      array->n_children != sizeof...(Ts)) {
+    throw std::invalid_argument("Arrow array is not a struct of " +
+                                std::to_string(sizeof...(Ts)) + " columns");
+  }
+  if (HasArrowNulls(*array, array->offset, array->length)) {
+    throw std::invalid_argument("Arrow array holds null rows");
+  }
+  (ImportArrowColumn(*schema->children[Is], *array->children[Is],
+                     array->offset + array->children[Is]->offset,
+                     array->length, std::get<Is>(columns)),
+   ...);
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,318 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+#include "hash.hpp"
+#include "string_column.hpp"
+
+namespace df {
+/**
+ * @brief Column type holding values of type @V dictionary-encoded, e.g.
+ * `DataFrame<int, cat>` for a column of strings with few distinct values.
+ *
+ * The column keeps every distinct value once, in a dictionary, and a code of
+ * type @Code per row: the index of its value in the dictionary. Appending a
+ * value looks it up in a hash table over the dictionary, adding it if it is
+ * new. Group-bys, joins, hash indexes, filters and sorts work on the codes,
+ * touching every distinct value once rather than once per row.
+ *
+ * Values are appended and read like those of a column of @V, e.g. as
+ * `std::string_view`s for df::str.
+ */
+template <typename V = str, typename Code = std::uint32_t>
+struct Categorical {
+  static_assert(std::is_unsigned_v<Code> && sizeof(Code) <= 4,
+                "Categorical codes must be unsigned integers of at most 32 "
+                "bits");
+};
+
+/**
+ * @brief Column type holding dictionary-encoded strings.
+ */
+using cat = Categorical<>;
+
+namespace impl {
+/**
+ * @brief Storage of a column of df::Categorical: the dictionary of distinct
+ * values, in order of first appearance, the code of every row, and a hash
+ * table from the values of the dictionary to their codes.
+ *
+ * The hash table is only allocated with the first value, so that empty
+ * columns do not allocate. Values can only be appended at the end.
+ */
+template <typename V, typename Code>
+class Column<Categorical<V, Code>> {
+ public:
+  using value_type = ColumnValue<V>;
+  using reference = ColumnConstReference<V>;
+  using const_reference = ColumnConstReference<V>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+  using code_type = Code;
+
+  using const_iterator = ColumnIterator<Column>;
+  using iterator = const_iterator;
+
+  /** Code returned by find() for values outside the dictionary. */
+  static constexpr std::uint32_t NotFound = KeyTable<V>::NotFound;
+
+  /** Largest number of distinct values of a column. */
+  static constexpr std::size_t MaxCategories = std::min<std::size_t>(
+      std::size_t{std::numeric_limits<Code>::max()} + 1, NotFound);
+
+  Column() noexcept = default;
+
+  explicit Column(allocator_type alloc) noexcept
+      : dictionary_{alloc}, codes_{alloc} {}
+
+  Column(Column const& other) = default;
+
+  Column(Column const& other, allocator_type alloc)
+      : dictionary_{other.dictionary_, alloc},
+        codes_{other.codes_, alloc},
+        table_{other.table_} {}
+
+  Column(Column&& other) noexcept
+      : dictionary_{std::move(other.dictionary_)},
+        codes_{std::move(other.codes_)},
+        table_{std::exchange(other.table_, std::nullopt)} {}
+
+  Column(Column&& other, allocator_type alloc)
+      : dictionary_{std::move(other.dictionary_), alloc},
+        codes_{std::move(other.codes_), alloc},
+        table_{std::exchange(other.table_, std::nullopt)} {}
+
+  auto operator=(Column const& other) -> Column& = default;
+
+  auto operator=(Column&& other) noexcept -> Column& {
+    Column{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  auto size() const noexcept -> std::size_t { return codes_.size(); }
+
+  auto empty() const noexcept -> bool { return codes_.empty(); }
+
+  auto capacity() const noexcept -> std::size_t { return codes_.capacity(); }
+
+  /**
+   * @brief Make room for the codes of @numValues values. The dictionary
+   * grows as new values are appended.
+   */
+  auto reserve(std::size_t numValues) -> void { codes_.reserve(numValues); }
+
+  /**
+   * @brief Remove all the values, and the dictionary with them.
+   */
+  auto clear() noexcept -> void {
+    codes_.clear();
+    dictionary_.clear();
+    table_.reset();
+  }
+
+  auto get_allocator() const noexcept -> allocator_type {
+    return codes_.get_allocator();
+  }
+
+  auto operator[](std::size_t i) const noexcept -> const_reference {
+    return dictionary_[codes_[i]];
+  }
+
+  auto begin() const noexcept -> const_iterator { return {this, 0}; }
+
+  auto end() const noexcept -> const_iterator { return {this, size()}; }
+
+  /**
+   * @brief Returns the distinct values of the column, indexed by code.
+   */
+  auto dictionary() const noexcept -> Column<V> const& { return dictionary_; }
+
+  /**
+   * @brief Returns the code of every row.
+   */
+  auto codes() const noexcept -> Column<Code> const& { return codes_; }
+
+  /**
+   * @brief Returns the code of every row, for writing. Callers must keep
+   * every code within the dictionary.
+   */
+  auto codes() noexcept -> Column<Code>& { return codes_; }
+
+  /**
+   * @brief Returns the code of row @i.
+   */
+  auto code(std::size_t i) const noexcept -> Code { return codes_[i]; }
+
+  /**
+   * @brief Returns the code of @value, or NotFound if no row holds it.
+   */
+  auto find(const_reference value) const -> std::uint32_t {
+    if (!table_) {
+      return NotFound;
+    }
+    return table_->find(CombineHash(0, value), KeyRefs{value}, keysOf());
+  }
+
+  /**
+   * @brief Returns the code of @value, adding it to the dictionary if it is
+   * not there yet.
+   *
+   * @throws std::length_error if the dictionary already holds MaxCategories
+   * values.
+   */
+  auto intern(const_reference value) -> Code {
+    if (!table_) {
+      table_.emplace();
+    }
+    std::uint64_t const hash = CombineHash(0, value);
+    if (dictionary_.size() == MaxCategories) {
+      std::uint32_t const code = table_->find(hash, KeyRefs{value}, keysOf());
+      if (code == NotFound) {
+        throw std::length_error("Too many categories for the code type");
+      }
+      return static_cast<Code>(code);
+    }
+    auto const [code, inserted] =
+        table_->insert(hash, KeyRefs{value}, keysOf());
+    if (inserted) {
+      dictionary_.push_back(value);
+    }
+    return static_cast<Code>(code);
+  }
+
+  /**
+   * @brief Returns the code in this column of every value of the dictionary
+   * of @from, adding those that are not in the dictionary yet.
+   */
+  auto mapDictionary(Column const& from) -> std::vector<Code> {
+    std::vector<Code> codes(from.dictionary_.size());
+    for (std::size_t c = 0; c < codes.size(); ++c) {
+      codes[c] = intern(from.dictionary_[c]);
+    }
+    return codes;
+  }
+
+  auto push_back(const_reference value) -> void {
+    codes_.push_back(intern(value));
+  }
+
+  /**
+   * @brief Append the value constructed from @args.
+   */
+  template <typename... Args>
+  auto emplace_back(Args&&... args) -> const_reference {
+    push_back(value_type(std::forward<Args>(args)...));
+    return (*this)[size() - 1];
+  }
+
+  /**
+   * @brief Append the values of [@first, @last), which must not belong to
+   * this column. @pos must be end().
+   *
+   * Values of another column of the same type, possibly through move
+   * iterators, are appended by translating their codes, looking up every
+   * value of its dictionary once.
+   */
+  template <std::input_iterator It>
+  auto insert(const_iterator pos, It first, It last) -> const_iterator {
+    assert(pos == end());
+    (void)pos;
+    std::size_t const row = size();
+    if constexpr (std::is_same_v<It, std::move_iterator<const_iterator>>) {
+      insert(pos, first.base(), last.base());
+    } else if constexpr (std::is_same_v<It, const_iterator>) {
+      appendRows(first.column(), first.row(), last.row());
+    } else {
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    }
+    return {this, row};
+  }
+
+  auto swap(Column& other) noexcept -> void {
+    dictionary_.swap(other.dictionary_);
+    codes_.swap(other.codes_);
+    table_.swap(other.table_);
+  }
+
+ private:
+  using KeyRefs = typename KeyTable<V>::KeyRefs;
+
+  auto keysOf() const {
+    return [this](std::uint32_t code) { return KeyRefs{dictionary_[code]}; };
+  }
+
+  /**
+   * @brief Append the values of rows [@first, @last) of @from.
+   */
+  auto appendRows(Column const& from, std::size_t first, std::size_t last)
+      -> void {
+    assert(&from != this);
+    if (first == last) {
+      return;
+    }
+    std::vector<Code> const codes = mapDictionary(from);
+    std::size_t const base = codes_.size();
+    codes_.resize(base + (last - first));
+    for (std::size_t i = first; i < last; ++i) {
+      codes_[base + i - first] = codes[from.codes_[i]];
+    }
+  }
+
+  Column<V> dictionary_;
+  Column<Code> codes_;
+  std::optional<KeyTable<V>> table_;
+};
+
+/**
+ * @brief Categorical columns are keyed on their codes, which are equal
+ * exactly when their values are.
+ */
+template <typename V, typename Code>
+struct KeyTraits<Categorical<V, Code>> {
+  using Type = Code;
+
+  static auto Get(Column<Categorical<V, Code>> const& column,
+                  std::size_t row) noexcept -> Code {
+    return column.code(row);
+  }
+};
+
+template <typename V, typename Code>
+inline constexpr bool IsCategorical<Categorical<V, Code>> = true;
+
+template <typename V, typename Code>
+inline constexpr bool IsString<Categorical<V, Code>> = IsString<V>;
+}  // namespace impl
+}  // namespace df
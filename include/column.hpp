@@ -0,0 +1,277 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace df {
+template <typename V, typename Code>
+struct Categorical;
+
+template <typename T>
+struct Nullable;
+
+template <typename T>
+struct Rle;
+
+template <typename T>
+struct BitPacked;
+
+template <typename T>
+struct Delta;
+
+namespace impl {
+/**
+ * @brief Storage of a column of values of type @T. Columns allocate from the
+ * memory resource of their %DataFrame.
+ *
+ * Column types other than plain values, such as df::str, specialize it with
+ * the subset of the interface of `std::vector` the library relies on:
+ * `size()`, `capacity()`, `reserve()`, `clear()`, `operator[]`, iteration,
+ * `push_back()`, `emplace_back()`, `insert()` at the end and
+ * `get_allocator()`, along with the member types `value_type`, `reference`
+ * and `const_reference`.
+ */
+template <typename T>
+class Column : public std::pmr::vector<T> {
+ public:
+  using std::pmr::vector<T>::vector;
+};
+
+/**
+ * @brief Random-access iterator over the values of a column of type @C that
+ * returns them through `operator[]`, for column types not backed by a
+ * `std::vector`.
+ */
+template <typename C>
+class ColumnIterator {
+ public:
+  using iterator_concept = std::random_access_iterator_tag;
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename C::value_type;
+  using difference_type = std::ptrdiff_t;
+  using reference = typename C::const_reference;
+  using pointer = void;
+
+  ColumnIterator() noexcept = default;
+
+  ColumnIterator(C const* column, std::size_t row) noexcept
+      : column_{column}, row_{row} {}
+
+  /** Column iterated over. */
+  auto column() const noexcept -> C const& { return *column_; }
+
+  /** Row the iterator points to. */
+  auto row() const noexcept -> std::size_t { return row_; }
+
+  auto operator*() const -> reference { return (*column_)[row_]; }
+
+  auto operator[](difference_type n) const -> reference {
+    return (*column_)[row_ + n];
+  }
+
+  auto operator++() noexcept -> ColumnIterator& {
+    ++row_;
+    return *this;
+  }
+
+  auto operator++(int) noexcept -> ColumnIterator {
+    return {column_, row_++};
+  }
+
+  auto operator--() noexcept -> ColumnIterator& {
+    --row_;
+    return *this;
+  }
+
+  auto operator--(int) noexcept -> ColumnIterator {
+    return {column_, row_--};
+  }
+
+  auto operator+=(difference_type n) noexcept -> ColumnIterator& {
+    row_ += n;
+    return *this;
+  }
+
+  auto operator-=(difference_type n) noexcept -> ColumnIterator& {
+    row_ -= n;
+    return *this;
+  }
+
+  friend auto operator+(ColumnIterator it, difference_type n) noexcept
+      -> ColumnIterator {
+    return it += n;
+  }
+
+  friend auto operator+(difference_type n, ColumnIterator it) noexcept
+      -> ColumnIterator {
+    return it += n;
+  }
+
+  friend auto operator-(ColumnIterator it, difference_type n) noexcept
+      -> ColumnIterator {
+    return it -= n;
+  }
+
+  friend auto operator-(ColumnIterator a, ColumnIterator b) noexcept
+      -> difference_type {
+    return static_cast<difference_type>(a.row_) -
+           static_cast<difference_type>(b.row_);
+  }
+
+  friend auto operator==(ColumnIterator a, ColumnIterator b) noexcept
+      -> bool {
+    return a.row_ == b.row_;
+  }
+
+  friend auto operator<=>(ColumnIterator a, ColumnIterator b) noexcept
+      -> std::strong_ordering {
+    return a.row_ <=> b.row_;
+  }
+
+ private:
+  C const* column_ = nullptr;
+  std::size_t row_ = 0;
+};
+
+/**
+ * @brief Type of the values of a column of @T, as appended and returned by
+ * value.
+ */
+template <typename T>
+using ColumnValue = typename Column<T>::value_type;
+
+/**
+ * @brief Type returned by read/write access to the values of a column of @T.
+ */
+template <typename T>
+using ColumnReference = typename Column<T>::reference;
+
+/**
+ * @brief Type returned by read-only access to the values of a column of @T.
+ */
+template <typename T>
+using ColumnConstReference = typename Column<T>::const_reference;
+
+/**
+ * @brief Whether columns of @T store their values in a contiguous array,
+ * which can be viewed as a span.
+ */
+template <typename T>
+inline constexpr bool IsContiguous =
+    std::contiguous_iterator<typename Column<T>::iterator>;
+
+/**
+ * @brief Type parameter of the columns storing values of type @V, as
+ * produced by expressions: @V itself unless a column type specializes it.
+ */
+template <typename V>
+struct ColumnFor {
+  using type = V;
+};
+
+/**
+ * @brief Whether the values of columns of @T can be assigned in place
+ * through the references returned by `operator[]`, rather than being
+ * returned by value or read-only.
+ */
+template <typename T>
+inline constexpr bool IsAssignable =
+    std::is_assignable_v<ColumnReference<T>, ColumnValue<T>> &&
+    !std::is_same_v<ColumnReference<T>, ColumnValue<T>>;
+
+/**
+ * @brief How the rows of a column of @T are compared as keys by group-bys,
+ * joins and hash indexes: `Type` is the key of a row, returned by
+ * `Get(column, row)`. Keys are the values themselves unless a column type
+ * specializes it, e.g. categorical columns compare their codes.
+ */
+template <typename T>
+struct KeyTraits {
+  using Type = ColumnConstReference<T>;
+
+  static auto Get(Column<T> const& column, std::size_t row) -> Type {
+    return column[row];
+  }
+};
+
+/**
+ * @brief Type of the key of a row of a column of @T.
+ */
+template <typename T>
+using KeyRef = typename KeyTraits<T>::Type;
+
+/**
+ * @brief Returns the key of row @row of @column.
+ */
+template <typename T>
+auto KeyOf(Column<T> const& column, std::size_t row) -> KeyRef<T> {
+  return KeyTraits<T>::Get(column, row);
+}
+
+/**
+ * @brief Type of the values of columns of @T other than nulls, which
+ * reductions compute on: ColumnValue<T> unless a column type specializes
+ * it, e.g. nullable columns.
+ */
+template <typename T>
+struct NonNull {
+  using type = ColumnValue<T>;
+};
+
+template <typename T>
+using NonNullType = typename NonNull<T>::type;
+
+/**
+ * @brief Whether columns of @T can hold nulls (see df::Nullable).
+ */
+template <typename T>
+inline constexpr bool IsNullable = false;
+
+/**
+ * @brief Whether columns of @T are dictionary-encoded, holding a code per
+ * row into a dictionary of distinct values (see df::Categorical).
+ */
+template <typename T>
+inline constexpr bool IsCategorical = false;
+
+/**
+ * @brief Whether columns of @T are compressed (see df::Rle, df::BitPacked
+ * and df::Delta). Encoded columns hand their values to scans in decoded
+ * blocks through `forEachBlock()`, and compute their own reductions.
+ */
+template <typename T>
+inline constexpr bool IsEncoded = false;
+
+/**
+ * @brief Whether the values of columns of @T are strings of chars, stored
+ * by loaders and exporters as variable-length text whatever their layout.
+ */
+template <typename T>
+inline constexpr bool IsString = false;
+
+template <typename Alloc>
+inline constexpr bool
+    IsString<std::basic_string<char, std::char_traits<char>, Alloc>> = true;
+}  // namespace impl
+}  // namespace df
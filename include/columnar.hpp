@@ -0,0 +1,297 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "column.hpp"
+
+/**
+ * Layout of the native columnar file format, in host byte order:
+ *
+ *   ColumnarFileHeader
+ *   ColumnarColumnHeader, one per column
+ *   one data block per column
+ *
+ * Every block starts at a multiple of ColumnarAlignment bytes. Fixed-size
+ * columns store their values contiguously (bool as one byte per value).
+ * String columns store `numRows + 1` uint64 offsets into a block holding
+ * the bytes of all the strings back to back.
+ */
+namespace df {
+namespace impl {
+inline constexpr char ColumnarMagic[8] = {'D', 'F', 'C', 'O', 'L', 'S', 0, 0};
+inline constexpr std::uint32_t ColumnarVersion = 1;
+inline constexpr std::uint32_t ColumnarByteOrderMark = 0x01020304;
+inline constexpr std::uint64_t ColumnarAlignment = 64;
+
+enum class ColumnarType : std::uint32_t {
+  Bool = 1,
+  Char,
+  SignedInt,
+  UnsignedInt,
+  Float,
+  String,
+};
+
+struct ColumnarFileHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrderMark;
+  std::uint64_t numRows;
+  std::uint32_t numCols;
+  std::uint32_t reserved;
+};
+
+struct ColumnarColumnHeader {
+  ColumnarType type;
+  // Size of a value in bytes, or of an offset for string columns.
+  std::uint32_t elementSize;
+  std::uint64_t dataOffset;
+  std::uint64_t dataSize;
+  // Offset of the offsets block of string columns, 0 otherwise.
+  std::uint64_t offsetsOffset;
+};
+
+/**
+ * @brief Returns the on-disk type of a column holding values of type @T.
+ */
+template <typename T>
+constexpr auto ColumnarTypeOf() noexcept -> ColumnarType {
+  if constexpr (IsString<T>) {
+    return ColumnarType::String;
+  } else if constexpr (std::is_same_v<T, bool>) {
+    return ColumnarType::Bool;
+  } else if constexpr (std::is_same_v<T, char>) {
+    return ColumnarType::Char;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return ColumnarType::Float;
+  } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+    return ColumnarType::SignedInt;
+  } else {
+    static_assert(std::is_integral_v<T>,
+                  "Columnar files hold arithmetic types and std::string");
+    return ColumnarType::UnsignedInt;
+  }
+}
+
+/**
+ * @brief Returns the size in bytes of an element of a column of @T, as
+ * stored in ColumnarColumnHeader::elementSize.
+ */
+template <typename T>
+constexpr auto ColumnarElementSize() noexcept -> std::uint32_t {
+  if constexpr (IsString<T>) {
+    return sizeof(std::uint64_t);
+  } else {
+    return sizeof(T);
+  }
+}
+
+constexpr auto AlignUp(std::uint64_t offset,
+                       std::uint64_t alignment = ColumnarAlignment) noexcept
+    -> std::uint64_t {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Buffered sequential writer over a file descriptor.
+ */
+class FileWriter {
+ public:
+  /**
+   * @brief Create or truncate the file at @path.
+   * @throws std::system_error if the file cannot be created.
+   */
+  explicit FileWriter(std::string const& path) : path_{path} {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "cannot create " + path);
+    }
+    buffer_.reserve(BufferSize);
+  }
+
+  ~FileWriter() noexcept {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+  }
+
+  FileWriter(FileWriter const&) = delete;
+  auto operator=(FileWriter const&) -> FileWriter& = delete;
+
+  /**
+   * @brief Append @size bytes from @data to the file.
+   */
+  auto write(void const* data, std::size_t size) -> void {
+    auto const* bytes = static_cast<char const*>(data);
+    if (buffer_.size() + size > BufferSize) {
+      flush();
+    }
+    if (size >= BufferSize) {
+      writeAll(bytes, size);
+    } else {
+      buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+    position_ += size;
+  }
+
+  /**
+   * @brief Append zero bytes up to the next multiple of ColumnarAlignment.
+   */
+  auto pad() -> void {
+    static constexpr char Zeros[ColumnarAlignment] = {};
+    write(Zeros, AlignUp(position_) - position_);
+  }
+
+  /**
+   * @brief Flush the buffered data and close the file.
+   * @throws std::system_error if the data cannot be written.
+   */
+  auto close() -> void {
+    flush();
+    int fd = fd_;
+    fd_ = -1;
+    if (::close(fd) < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "cannot write " + path_);
+    }
+  }
+
+ private:
+  static constexpr std::size_t BufferSize = 1 << 20;
+
+  auto flush() -> void {
+    writeAll(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+  auto writeAll(char const* data, std::size_t size) -> void {
+    while (size > 0) {
+      ssize_t written = ::write(fd_, data, size);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::system_error(errno, std::generic_category(),
+                                "cannot write " + path_);
+      }
+      data += written;
+      size -= written;
+    }
+  }
+
+  std::string path_;
+  int fd_ = -1;
+  std::vector<char> buffer_;
+  std::uint64_t position_ = 0;
+};
+
+/**
+ * @brief Fill in the header of a column and advance @offset past its blocks.
+ */
+template <typename T>
+auto LayOutColumn(Column<T> const& column, std::uint64_t& offset)
+    -> ColumnarColumnHeader {
+  ColumnarColumnHeader header{ColumnarTypeOf<T>(), ColumnarElementSize<T>(),
+                              0, 0, 0};
+  if constexpr (IsString<T>) {
+    header.offsetsOffset = offset;
+    offset = AlignUp(offset + (column.size() + 1) * sizeof(std::uint64_t));
+    for (auto const& s : column) {
+      header.dataSize += s.size();
+    }
+  } else {
+    header.dataSize = column.size() * sizeof(T);
+  }
+  header.dataOffset = offset;
+  offset = AlignUp(offset + header.dataSize);
+  return header;
+}
+
+/**
+ * @brief Write the blocks of a column.
+ */
+template <typename T>
+auto WriteColumn(Column<T> const& column, FileWriter& writer) -> void {
+  if constexpr (IsString<T>) {
+    std::uint64_t offset = 0;
+    writer.write(&offset, sizeof(offset));
+    for (auto const& s : column) {
+      offset += s.size();
+      writer.write(&offset, sizeof(offset));
+    }
+    writer.pad();
+    for (auto const& s : column) {
+      writer.write(s.data(), s.size());
+    }
+  } else if constexpr (std::is_same_v<T, bool>) {
+    for (bool b : column) {
+      char byte = b;
+      writer.write(&byte, 1);
+    }
+  } else {
+    writer.write(column.data(), column.size() * sizeof(T));
+  }
+  writer.pad();
+}
+
+/**
+ * @brief Write @columns to @path in the native columnar format.
+ *
+ * @param columns The columns of the DF.
+ * @param path Path of the file to create or overwrite.
+ * @throws std::system_error if the file cannot be written.
+ */
+template <typename... Ts, std::size_t... Is>
+auto SaveColumnar(std::tuple<Column<Ts>...> const& columns,
+                  std::string const& path, std::index_sequence<Is...>)
+    -> void {
+  ColumnarFileHeader fileHeader{};
+  std::memcpy(fileHeader.magic, ColumnarMagic, sizeof(ColumnarMagic));
+  fileHeader.version = ColumnarVersion;
+  fileHeader.byteOrderMark = ColumnarByteOrderMark;
+  fileHeader.numRows = std::get<0>(columns).size();
+  fileHeader.numCols = sizeof...(Ts);
+
+  std::uint64_t offset =
+      AlignUp(sizeof(ColumnarFileHeader) +
+              sizeof...(Ts) * sizeof(ColumnarColumnHeader));
+  ColumnarColumnHeader const columnHeaders[] = {
+      LayOutColumn(std::get<Is>(columns), offset)...};
+
+  FileWriter writer{path};
+  writer.write(&fileHeader, sizeof(fileHeader));
+  writer.write(columnHeaders, sizeof(columnHeaders));
+  writer.pad();
+  (WriteColumn(std::get<Is>(columns), writer), ...);
+  writer.close();
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,553 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "dataframe.hpp"
+#include "mapped_file.hpp"
+
+namespace df {
+/**
+ * @brief Options controlling how CSV files are parsed.
+ *
+ * Fields are not unquoted: a delimiter always ends a field. Both LF and CRLF
+ * line endings are accepted, and empty lines are skipped.
+ */
+struct CsvOptions {
+  char delimiter = ',';
+  bool header = false;
+  /**
+   * Number of threads used to parse the file. Zero selects one thread per
+   * hardware core. Small files are parsed with fewer threads.
+   */
+  unsigned threads = 1;
+};
+
+namespace impl {
+/**
+ * @brief Finds the delimiters and newlines of a buffer, 64 bytes at a time.
+ *
+ * Each block is turned into a bitmask of structural characters using vector
+ * compares, and the positions are then popped one by one from the mask.
+ */
+class StructuralScanner {
+ public:
+  StructuralScanner(char const* begin, char const* end, char delimiter) noexcept
+      : block_{begin}, end_{end}, delimiter_{delimiter} {
+    fill();
+  }
+
+  /**
+   * @brief Returns the position of the next delimiter or newline, or the end
+   * of the buffer if there are none left.
+   */
+  auto next() noexcept -> char const* {
+    while (mask_ == 0) {
+      if (end_ - block_ <= BlockSize) {
+        block_ = end_;
+        return end_;
+      }
+      block_ += BlockSize;
+      fill();
+    }
+    char const* pos = block_ + std::countr_zero(mask_);
+    mask_ &= mask_ - 1;
+    return pos;
+  }
+
+ private:
+  static constexpr std::ptrdiff_t BlockSize = 64;
+
+  auto fill() noexcept -> void {
+    if (end_ - block_ < BlockSize) {
+      mask_ = 0;
+      for (std::ptrdiff_t i = 0; i < end_ - block_; ++i) {
+        mask_ |= static_cast<std::uint64_t>(block_[i] == delimiter_ ||
+                                            block_[i] == '\n')
+                 << i;
+      }
+      return;
+    }
+#if defined(__AVX2__)
+    __m256i const d = _mm256_set1_epi8(delimiter_);
+    __m256i const n = _mm256_set1_epi8('\n');
+    auto match = [&](char const* p) -> std::uint64_t {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+      __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, d),
+                                  _mm256_cmpeq_epi8(v, n));
+      return static_cast<std::uint32_t>(_mm256_movemask_epi8(m));
+    };
+    mask_ = match(block_) | (match(block_ + 32) << 32);
+#elif defined(__SSE2__)
+    __m128i const d = _mm_set1_epi8(delimiter_);
+    __m128i const n = _mm_set1_epi8('\n');
+    auto match = [&](char const* p) -> std::uint64_t {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+      __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, d), _mm_cmpeq_epi8(v, n));
+      return static_cast<std::uint32_t>(_mm_movemask_epi8(m));
+    };
+    mask_ = match(block_) | (match(block_ + 16) << 16) |
+            (match(block_ + 32) << 32) | (match(block_ + 48) << 48);
+#else
+    mask_ = 0;
+    for (std::ptrdiff_t i = 0; i < BlockSize; ++i) {
+      mask_ |= static_cast<std::uint64_t>(block_[i] == delimiter_ ||
+                                          block_[i] == '\n')
+               << i;
+    }
+#endif
+  }
+
+  char const* block_;
+  char const* end_;
+  std::uint64_t mask_ = 0;
+  char delimiter_;
+};
+
+/**
+ * @brief Parse a single field holding a value of type @T into @value.
+ *
+ * @returns false if @field is not a valid value of @T.
+ */
+template <typename T>
+auto ParseValue(std::string_view field, T& value) -> bool {
+  if constexpr (std::is_same_v<T, char>) {
+    if (field.size() > 1) {
+      return false;
+    }
+    value = field.empty() ? '\0' : field.front();
+  } else if constexpr (std::is_same_v<T, bool>) {
+    if (field == "1" || field == "true") {
+      value = true;
+    } else if (field == "0" || field == "false") {
+      value = false;
+    } else {
+      return false;
+    }
+  } else {
+    static_assert(std::is_arithmetic_v<T>,
+                  "CSV columns must be arithmetic types or std::string");
+    auto [ptr, ec] =
+        std::from_chars(field.data(), field.data() + field.size(), value);
+    if (ec != std::errc{} || ptr != field.data() + field.size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Parse a single field and append it to @column. Empty fields are
+ * nulls in nullable columns.
+ *
+ * @param field The text of the field, without delimiters.
+ * @param column The column the value is appended to.
+ * @returns false if @field is not a valid value of the column type.
+ */
+template <typename T>
+auto ParseField(std::string_view field, Column<T>& column) -> bool {
+  if constexpr (IsString<T>) {
+    column.emplace_back(field);
+  } else if constexpr (IsNullable<T>) {
+    NonNullType<T> value{};
+    if (field.empty()) {
+      column.push_back(std::nullopt);
+    } else if (ParseValue(field, value)) {
+      column.push_back(value);
+    } else {
+      return false;
+    }
+  } else {
+    ColumnValue<T> value{};
+    if (!ParseValue(field, value)) {
+      return false;
+    }
+    column.push_back(value);
+  }
+  return true;
+}
+
+/**
+ * @brief Returns the position following the first newline in [@begin, @end),
+ * or @end if there is none.
+ */
+inline auto SkipLine(char const* begin, char const* end) noexcept
+    -> char const* {
+  char const* newline = std::find(begin, end, '\n');
+  return newline == end ? end : newline + 1;
+}
+
+/**
+ * @brief Estimate the number of rows in [@begin, @end) from the average line
+ * length of its first bytes.
+ */
+inline auto EstimateRowCount(char const* begin, char const* end) noexcept
+    -> std::size_t {
+  constexpr std::size_t SampleSize = 64 * 1024;
+  std::size_t const size = end - begin;
+  std::size_t const sample = std::min(size, SampleSize);
+  std::size_t const lines = std::count(begin, begin + sample, '\n');
+  if (sample == size) {
+    return lines + 1;
+  }
+  if (lines == 0) {
+    return 0;
+  }
+  // Leave some slack so that a slightly longer than average sample does not
+  // cost a reallocation of every column near the end of the file.
+  std::size_t const estimate = size * lines / sample;
+  return estimate + estimate / 16;
+}
+
+/**
+ * @brief Parse the rows in [@begin, @end) and append them to @columns.
+ *
+ * @param begin Start of the first row.
+ * @param end One past the end of the last row.
+ * @param columns The columns of the DF.
+ * @param delimiter The field delimiter.
+ * @param baseOffset Offset of @begin in the file, used in error messages.
+ * @param maxRows Maximum number of rows to parse.
+ * @returns The position following the last row parsed.
+ * @throws std::runtime_error on rows with a wrong number of fields or with
+ * values that cannot be parsed.
+ */
+template <typename... Ts, std::size_t... Is>
+auto ParseCsv(char const* begin, char const* end,
+              std::tuple<Column<Ts>...>& columns, char delimiter,
+              std::size_t baseOffset, std::size_t maxRows,
+              std::index_sequence<Is...>) -> char const* {
+  constexpr std::size_t NumCols = sizeof...(Ts);
+  StructuralScanner scanner{begin, end, delimiter};
+  char const* fieldBegin = begin;
+
+  auto fail = [&](char const* pos, char const* what) {
+    throw std::runtime_error(std::string{"malformed CSV row at byte "} +
+                             std::to_string(baseOffset + (pos - begin)) +
+                             ": " + what);
+  };
+
+  auto parseField = [&]<std::size_t I>(std::integral_constant<std::size_t, I>) {
+    char const* fieldEnd = scanner.next();
+    bool const isLast = I + 1 == NumCols;
+    if (fieldEnd == end ? !isLast : (*fieldEnd == '\n') != isLast) {
+      fail(fieldBegin, "wrong number of fields");
+    }
+    std::string_view field{fieldBegin,
+                           static_cast<std::size_t>(fieldEnd - fieldBegin)};
+    if (isLast && !field.empty() && field.back() == '\r') {
+      field.remove_suffix(1);
+    }
+    if (!ParseField(field, std::get<I>(columns))) {
+      fail(fieldBegin, "invalid value");
+    }
+    fieldBegin = fieldEnd + 1;
+  };
+
+  for (std::size_t numRows = 0; fieldBegin < end && numRows < maxRows;) {
+    if (*fieldBegin == '\n' || (*fieldBegin == '\r' && fieldBegin + 1 < end &&
+                                fieldBegin[1] == '\n')) {
+      fieldBegin = scanner.next() + 1;
+      continue;
+    }
+    (parseField(std::integral_constant<std::size_t, Is>{}), ...);
+    ++numRows;
+  }
+  return std::min(fieldBegin, end);
+}
+
+/**
+ * @brief Parse [@begin, @end) on several threads and return the result.
+ *
+ * The range is split in chunks that end on newlines. Each chunk is parsed into
+ * its own DF by a worker thread; the parts are then moved into the result,
+ * whose capacity is reserved once for the total number of rows.
+ *
+ * @param begin Start of the first row.
+ * @param end One past the end of the last row.
+ * @param options Parsing options.
+ * @param baseOffset Offset of @begin in the file, used in error messages.
+ */
+template <typename... Ts>
+auto ParseCsvParallel(char const* begin, char const* end,
+                      CsvOptions const& options, std::size_t baseOffset)
+    -> DataFrame<Ts...> {
+  // Below this many bytes per chunk, spawning threads does not pay off.
+  constexpr std::size_t MinChunkSize = 1 << 20;
+  std::size_t const size = end - begin;
+  // hardware_concurrency() returns 0 when the count is unknown.
+  std::size_t numChunks = std::max<std::size_t>(
+      1, options.threads ? options.threads
+                         : std::thread::hardware_concurrency());
+  numChunks = std::clamp<std::size_t>(size / MinChunkSize, 1, numChunks);
+
+  std::vector<char const*> bounds{begin};
+  for (std::size_t i = 1; i < numChunks; ++i) {
+    char const* split = std::max(begin + size / numChunks * i, bounds.back());
+    bounds.push_back(SkipLine(split, end));
+  }
+  bounds.push_back(end);
+
+  std::vector<DataFrame<Ts...>> parts(numChunks);
+  std::vector<std::exception_ptr> errors(numChunks);
+  auto parseChunk = [&](std::size_t i) {
+    try {
+      parts[i].reserve(EstimateRowCount(bounds[i], bounds[i + 1]));
+      ParseCsv(bounds[i], bounds[i + 1], ColumnAccess::Columns(parts[i]),
+               options.delimiter, baseOffset + (bounds[i] - begin),
+               std::numeric_limits<std::size_t>::max(),
+               std::make_index_sequence<sizeof...(Ts)>{});
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> workers;
+  auto const joinWorkers = [&] {
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  };
+  try {
+    workers.reserve(numChunks - 1);
+    for (std::size_t i = 1; i < numChunks; ++i) {
+      workers.emplace_back(parseChunk, i);
+    }
+  } catch (...) {
+    // The workers already started refer to the locals of this frame.
+    joinWorkers();
+    throw;
+  }
+  parseChunk(0);
+  joinWorkers();
+  for (auto const& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::size_t numRows = 0;
+  for (auto const& part : parts) {
+    numRows += part.size();
+  }
+  DataFrame<Ts...> df;
+  df.reserve(numRows);
+  for (auto& part : parts) {
+    df.append(std::move(part));
+  }
+  return df;
+}
+}  // namespace impl
+
+/**
+ * @brief Load a CSV file into a %DataFrame.
+ *
+ * The file is memory-mapped and each field is parsed straight into its
+ * column, whose capacity is presized from an estimate of the number of rows.
+ * With @options.threads other than 1, the file is parsed in parallel chunks.
+ *
+ * @param path Path of the CSV file.
+ * @param options Parsing options.
+ * @returns A %DataFrame with one row per non-empty line of the file.
+ * @throws std::system_error if the file cannot be read.
+ * @throws std::runtime_error if the file does not match the column types.
+ */
+template <typename... Ts>
+auto readCsv(std::string const& path, CsvOptions const& options = {})
+    -> DataFrame<Ts...> {
+  impl::MappedFile file{path};
+  char const* begin = file.data();
+  char const* end = begin + file.size();
+  if (options.header) {
+    begin = impl::SkipLine(begin, end);
+  }
+
+  if (options.threads != 1) {
+    return impl::ParseCsvParallel<Ts...>(begin, end, options,
+                                         begin - file.data());
+  }
+
+  DataFrame<Ts...> df;
+  df.reserve(impl::EstimateRowCount(begin, end));
+  impl::ParseCsv(begin, end, impl::ColumnAccess::Columns(df),
+                 options.delimiter, begin - file.data(),
+                 std::numeric_limits<std::size_t>::max(),
+                 std::make_index_sequence<sizeof...(Ts)>{});
+  return df;
+}
+
+/**
+ * @brief Reads a CSV file in batches of at most a given number of rows.
+ *
+ * The file is read through a fixed-size buffer that only grows to fit a
+ * single line longer than it, so memory use does not depend on the size of
+ * the file. Batches are parsed into a caller-provided %DataFrame whose
+ * column buffers are reused from one batch to the next. The threads option
+ * is ignored.
+ */
+template <typename... Ts>
+class CsvReader {
+ public:
+  /**
+   * @brief Open the CSV file at @path.
+   *
+   * @param path Path of the CSV file.
+   * @param batchSize Maximum number of rows per batch.
+   * @param options Parsing options.
+   * @throws std::system_error if the file cannot be opened.
+   */
+  CsvReader(std::string const& path, std::size_t batchSize,
+            CsvOptions const& options = {})
+      : path_{path}, batchSize_{batchSize}, options_{options} {
+    assert(batchSize_ > 0);
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "cannot open " + path);
+    }
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    buffer_.resize(BufferSize);
+    pos_ = parseEnd_ = dataEnd_ = buffer_.data();
+    skipHeader_ = options_.header;
+  }
+
+  ~CsvReader() noexcept { ::close(fd_); }
+
+  CsvReader(CsvReader const&) = delete;
+  auto operator=(CsvReader const&) -> CsvReader& = delete;
+
+  /**
+   * @brief Replace the content of @batch with the next rows of the file.
+   *
+   * @param batch The %DataFrame to fill. Its capacity is kept.
+   * @returns false once the whole file has been read.
+   * @throws std::system_error if the file cannot be read.
+   * @throws std::runtime_error if the file does not match the column types.
+   */
+  auto next(DataFrame<Ts...>& batch) -> bool {
+    batch.clear();
+    batch.reserve(batchSize_);
+    auto& columns = impl::ColumnAccess::Columns(batch);
+    while (static_cast<std::size_t>(batch.size()) < batchSize_) {
+      if (pos_ == parseEnd_ && !refill()) {
+        break;
+      }
+      char const* stop = impl::ParseCsv(
+          pos_, parseEnd_, columns, options_.delimiter,
+          bufferOffset_ + (pos_ - buffer_.data()), batchSize_ - batch.size(),
+          std::make_index_sequence<sizeof...(Ts)>{});
+      pos_ = stop;
+    }
+    return batch.size() > 0;
+  }
+
+  /**
+   * @brief Call @f on each batch of the rest of the file, in order.
+   *
+   * @param f Callable invoked with a `DataFrame<Ts...>&` holding the batch.
+   */
+  template <typename F>
+  auto forEachBatch(F&& f) -> void {
+    DataFrame<Ts...> batch;
+    while (next(batch)) {
+      f(batch);
+    }
+  }
+
+ private:
+  static constexpr std::size_t BufferSize = 1 << 20;
+
+  /**
+   * @brief Move the unparsed bytes to the front of the buffer and read more
+   * data after them, until the buffer holds at least one complete line.
+   *
+   * @returns false if the end of the file has been reached and there is
+   * nothing left to parse.
+   */
+  auto refill() -> bool {
+    std::size_t const leftover = dataEnd_ - pos_;
+    std::memmove(buffer_.data(), pos_, leftover);
+    bufferOffset_ += pos_ - buffer_.data();
+    std::size_t size = leftover;
+    for (;;) {
+      if (size == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+      }
+      ssize_t numRead = 0;
+      if (!eof_) {
+        numRead = ::read(fd_, buffer_.data() + size, buffer_.size() - size);
+        if (numRead < 0) {
+          throw std::system_error(errno, std::generic_category(),
+                                  "cannot read " + path_);
+        }
+        eof_ = numRead == 0;
+        size += numRead;
+      }
+      pos_ = buffer_.data();
+      dataEnd_ = pos_ + size;
+      char const* lastNewline =
+          std::find(std::make_reverse_iterator(dataEnd_),
+                    std::make_reverse_iterator(pos_), '\n')
+              .base();
+      parseEnd_ = eof_ ? dataEnd_ : lastNewline;
+      if (skipHeader_ && pos_ != parseEnd_) {
+        pos_ = impl::SkipLine(pos_, parseEnd_);
+        skipHeader_ = false;
+      }
+      if (pos_ != parseEnd_ || eof_) {
+        return pos_ != parseEnd_;
+      }
+    }
+  }
+
+  std::string path_;
+  std::size_t batchSize_;
+  CsvOptions options_;
+  int fd_ = -1;
+  bool eof_ = false;
+  bool skipHeader_ = false;
+  std::vector<char> buffer_;
+  // Offset in the file of the first byte of the buffer.
+  std::size_t bufferOffset_ = 0;
+  // Next byte to parse, end of the complete lines, and end of the data read.
+  char const* pos_ = nullptr;
+  char const* parseEnd_ = nullptr;
+  char const* dataEnd_ = nullptr;
+};
+}  // namespace df
@@ -16,48 +16,70 @@
  */
 #pragma once
 
-#include <cmath>
+#include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <span>
+#include <string>
 #include <tuple>
 #include <type_traits>
 #include <vector>
 
+#include "arrow.hpp"
+#include "categorical.hpp"
+#include "columnar.hpp"
 #include "dataframe_impl.hpp"
+#include "encoded.hpp"
+#include "execution.hpp"
+#include "expr.hpp"
+#include "gather.hpp"
+#include "group_by.hpp"
+#include "growth.hpp"
+#include "index.hpp"
 #include "iterator.hpp"
-
-namespace detail {
-template <auto...>
-struct AlwaysFalse {
-  static constexpr bool value = false;
-};
-}  // namespace detail
+#include "lazy.hpp"
+#include "mask.hpp"
+#include "nullable.hpp"
+#include "parallel.hpp"
+#include "reductions.hpp"
+#include "sort.hpp"
+#include "string_column.hpp"
 
 namespace df {
 template <typename... Ts>
 class DataFrame {
  public:
   static constexpr int NumCols = sizeof...(Ts);
-  using RowType = std::tuple<Ts...>;
-  using RefType = std::tuple<Ts&...>;
-  using ConstRefType = std::tuple<Ts const&...>;
+  using RowType = std::tuple<impl::ColumnValue<Ts>...>;
+  using RefType = std::tuple<impl::ColumnReference<Ts>...>;
+  using ConstRefType = std::tuple<impl::ColumnConstReference<Ts>...>;
 
   using RowIterator = RowIteratorImpl<DataFrame>;
   using ConstRowIterator = ConstRowIteratorImpl<DataFrame>;
 
+  template <std::size_t Col>
+  using ValueType = std::tuple_element_t<Col, RowType>;
+
  private:
-  // Helper functions to retrieve each column vector type.
+  /** Type parameter of column @Col, e.g. df::str. */
   template <std::size_t Col>
-  auto getCol() const -> auto{
-    static_assert(detail::AlwaysFalse<Col>::value, "Method cannot be called");
-    return std::get<Col>(columns_);
-  }
+  using ColumnParam = std::tuple_element_t<Col, std::tuple<Ts...>>;
 
   template <std::size_t Col>
-  using ColType = std::remove_reference_t<
-      decltype(std::declval<DataFrame>().template getCol<Col>())>;
+  using ColType = impl::Column<ColumnParam<Col>>;
 
  public:
+  /**
+   * Type of the non-null values of column @Col, which reductions compute on:
+   * ValueType<Col> unless the column is nullable.
+   */
+  template <std::size_t Col>
+  using ElementType = impl::NonNullType<ColumnParam<Col>>;
+
   template <std::size_t Col>
   using ColIterator = typename ColType<Col>::iterator;
 
@@ -65,51 +87,80 @@ class DataFrame {
   using ConstColIterator = typename ColType<Col>::const_iterator;
 
   /**
-   * @brief Default constructor. Create an empty DF.
+   * @brief Allocator of the columns. Every column allocates from the same
+   * memory resource, and so do string values of type `std::pmr::string`.
+   */
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  /**
+   * @brief Default constructor. Create an empty DF allocating from the
+   * default memory resource.
    */
   constexpr DataFrame() noexcept = default;
 
+  /**
+   * @brief Create an empty DF allocating from the memory resource of
+   * @alloc, e.g. a `std::pmr::monotonic_buffer_resource` whose memory is
+   * released in one shot. The resource must outlive the DF. Monotonic
+   * resources do not reuse the memory freed as columns grow, so reserve()
+   * the expected number of rows up front.
+   *
+   * @param alloc The allocator of the columns.
+   */
+  explicit DataFrame(allocator_type alloc) noexcept
+      : columns_{std::allocator_arg, alloc} {}
+
   /**
    * @brief Default destructor.
    */
   ~DataFrame() noexcept = default;
 
   /**
-   * @brief Copy constructor.
+   * @brief Copy constructor. As with `std::pmr` containers, the copy
+   * allocates from the default memory resource.
    *
    * @param df The DF from which the data is copied from.
    */
-  constexpr DataFrame(DataFrame const& df) noexcept {
-    int newCapacity = std::get<0>(df.columns_).capacity();
-    impl::ReserveColumns(columns_, newCapacity,
+  DataFrame(DataFrame const& df) : DataFrame{df, allocator_type{}} {}
+
+  /**
+   * @brief Copy constructor allocating from the memory resource of @alloc.
+   *
+   * @param df The DF from which the data is copied from.
+   * @param alloc The allocator of the columns.
+   */
+  DataFrame(DataFrame const& df, allocator_type alloc)
+      : columns_{std::allocator_arg, alloc}, growthPolicy_{df.growthPolicy_} {
+    impl::ReserveColumns(columns_, std::get<0>(df.columns_).capacity(),
                          std::make_index_sequence<NumCols>{});
-    std::cout << "NumCols = " << NumCols << "\n";
-    // impl::CopyColumns(df.columns_, columns_, std::index_sequence<NumCols>{});
-    for (int i = 0; i < df.size(); ++i) {
-      append(df.get(i));
-    }
+    impl::CopyColumns(df.columns_, columns_,
+                      std::make_index_sequence<NumCols>{});
   }
 
   /**
-   * @brief Move constructor. Clears data from @df.
+   * @brief Move constructor. Clears data from @df, whose memory resource is
+   * taken over.
    *
    * @param df The DF from which the data is moved from.
    */
-  constexpr DataFrame(DataFrame<Ts...>&& df) {
-    if (this == &df) {
-      return;
-    }
-    if (std::get<0>(columns_).capacity() <
-        std::get<0>(columns_).size() + std::get<0>(df.columns_).size()) {
-      int numElementsAfterAppend =
-          std::get<0>(columns_).size() + std::get<0>(df.columns_).size();
-      int newCapacity =
-          1 << static_cast<int>(std::ceil(std::log2(numElementsAfterAppend)));
-      impl::ReserveColumns(columns_, newCapacity,
-                           std::make_index_sequence<NumCols>{});
-    }
-    impl::MoveColumns(std::move(df.columns_), columns_,
-                      std::make_index_sequence<NumCols>{});
+  DataFrame(DataFrame<Ts...>&& df) noexcept
+      : columns_{std::move(df.columns_)}, growthPolicy_{df.growthPolicy_} {
+    ++df.generation_;
+  }
+
+  /**
+   * @brief Move constructor allocating from the memory resource of @alloc.
+   * The columns of @df are taken over if it uses the same resource, and
+   * moved element by element otherwise. Clears data from @df.
+   *
+   * @param df The DF from which the data is moved from.
+   * @param alloc The allocator of the columns.
+   */
+  DataFrame(DataFrame<Ts...>&& df, allocator_type alloc)
+      : columns_{std::allocator_arg, alloc, std::move(df.columns_)},
+        growthPolicy_{df.growthPolicy_} {
+    impl::ClearColumns(df.columns_, std::make_index_sequence<NumCols>{});
+    ++df.generation_;
   }
 
   /**
@@ -120,6 +171,16 @@ class DataFrame {
    */
   constexpr auto begin() noexcept -> RowIterator { return {this, 0}; }
 
+  /**
+   * @brief Returns a read-only iterator that points to the first row of the
+   * data. Iteration is done in ordinary element order.
+   *
+   * @return A read-only row iterator pointing to the first row.
+   */
+  constexpr auto begin() const noexcept -> ConstRowIterator {
+    return {this, 0};
+  }
+
   /**
    * @brief Returns a read-only iterator that points to the first row of the
    * data. Iteration is done in ordinary element order.
@@ -138,6 +199,16 @@ class DataFrame {
    */
   constexpr auto end() noexcept -> RowIterator { return {this, size()}; }
 
+  /**
+   * @brief Returns a read-only iterator that points one past the last
+   * row of the data. Iteration is done in ordinary element order.
+   *
+   * @return A read-only row iterator pointing one past the last row.
+   */
+  constexpr auto end() const noexcept -> ConstRowIterator {
+    return {this, size()};
+  }
+
   /**
    * @brief Returns a read-only iterator that points one past the last
    * row of the data. Iteration is done in ordinary element order.
@@ -148,10 +219,17 @@ class DataFrame {
     return {this, size()};
   }
 
+  /**
+   * @brief Returns the allocator of the columns.
+   */
+  auto get_allocator() const noexcept -> allocator_type {
+    return std::get<0>(columns_).get_allocator();
+  }
+
   /**
    * @brief Returns the number of rows stored in the %DataFrame.
    */
-  constexpr auto size() const noexcept -> int {
+  constexpr auto size() const noexcept -> std::size_t {
     return std::get<0>(columns_).size();
   }
 
@@ -159,7 +237,7 @@ class DataFrame {
    * @brief Returns the total number of elements that the %DataFrame can hold
    * before needing to allocate more memory.
    */
-  constexpr auto capacity() const noexcept -> int {
+  constexpr auto capacity() const noexcept -> std::size_t {
     return std::get<0>(columns_).capacity();
   }
 
@@ -172,11 +250,40 @@ class DataFrame {
                          std::make_index_sequence<NumCols>{});
   }
 
+  /**
+   * @brief Returns how the %DataFrame grows when rows are appended past its
+   * capacity.
+   */
+  constexpr auto growthPolicy() const noexcept -> GrowthPolicy {
+    return growthPolicy_;
+  }
+
+  /**
+   * @brief Set how the %DataFrame grows when rows are appended past its
+   * capacity. The default, GrowthPolicy::Double, rounds the capacity up to
+   * the next power of two.
+   */
+  constexpr auto setGrowthPolicy(GrowthPolicy policy) noexcept -> void {
+    growthPolicy_ = policy;
+  }
+
+  /**
+   * @brief Remove all the rows of the %DataFrame. The capacity is kept, so
+   * the %DataFrame can be refilled without allocating.
+   */
+  constexpr auto clear() noexcept -> void {
+    impl::ClearColumns(columns_, std::make_index_sequence<NumCols>{});
+    ++generation_;
+  }
+
   /**
    *  @brief Append a row to the end of the %DataFrame.
    *  @param em Data to be added.
+   *  @throws std::length_error if a categorical column runs out of codes.
    */
-  constexpr auto append(Ts const&... em) noexcept -> void {
+  constexpr auto append(impl::ColumnValue<Ts> const&... em) noexcept(
+      !(impl::IsCategorical<Ts> || ...)) -> void {
+    reserveForAppend(1);
     impl::Append(columns_, std::tie(em...),
                  std::make_index_sequence<NumCols>{});
   }
@@ -184,9 +291,13 @@ class DataFrame {
   /**
    *  @brief Append a row to the end of the %DataFrame.
    *  @param em Data to be added.
+   *  @throws std::length_error if a categorical column runs out of codes.
    */
-  constexpr auto append(Ts&&... em) noexcept -> void {
-    impl::Append(columns_, std::tuple(std::forward<Ts>(em)...),
+  constexpr auto append(impl::ColumnValue<Ts>&&... em) noexcept(
+      !(impl::IsCategorical<Ts> || ...)) -> void {
+    reserveForAppend(1);
+    impl::Append(columns_,
+                 std::tuple(std::forward<impl::ColumnValue<Ts>>(em)...),
                  std::make_index_sequence<NumCols>{});
   }
 
@@ -194,7 +305,8 @@ class DataFrame {
    *  @brief Append a row to the end of the %DataFrame.
    *  @param em Data to be added.
    */
-  constexpr auto append(std::tuple<Ts...> const& em) -> void {
+  constexpr auto append(RowType const& em) -> void {
+    reserveForAppend(1);
     impl::Append(columns_, em, std::make_index_sequence<NumCols>{});
   }
 
@@ -202,8 +314,9 @@ class DataFrame {
    *  @brief Append a row to the end of the %DataFrame.
    *  @param em Data to be added.
    */
-  constexpr auto append(std::tuple<Ts...>&& em) -> void {
-    impl::Append(columns_, std::forward<std::tuple<Ts...>>(em),
+  constexpr auto append(RowType&& em) -> void {
+    reserveForAppend(1);
+    impl::Append(columns_, std::move(em),
                  std::make_index_sequence<NumCols>{});
   }
 
@@ -212,56 +325,682 @@ class DataFrame {
    *  @param df %DataFrame whose data is to be appended to %DataFrame.
    */
   constexpr auto append(DataFrame<Ts...> const& df) -> void {
-    if (std::get<0>(columns_).capacity() <
-        std::get<0>(columns_).size() + std::get<0>(df.columns_).size()) {
-      int numElementsAfterAppend =
-          std::get<0>(columns_).size() + std::get<0>(df.columns_).size();
-      int newCapacity =
-          1 << static_cast<int>(std::ceil(std::log2(numElementsAfterAppend)));
-      impl::ReserveColumns(columns_, newCapacity,
-                           std::make_index_sequence<NumCols>{});
-    }
-    // impl::CopyColumns(df.columns_, columns_, std::index_sequence<NumCols>{});
-    for (int i = 0; i < df.size(); ++i) {
-      append(df.get(i));
+    if (this == &df) {
+      // Range inserts may not alias the destination, so go through a copy.
+      append(DataFrame{df});
+      return;
     }
+    reserveForAppend(std::get<0>(df.columns_).size());
+    impl::CopyColumns(df.columns_, columns_,
+                      std::make_index_sequence<NumCols>{});
   }
 
   /**
    *  @brief Append the data in @df to the end of the %DataFrame by move.
+   *  An empty %DataFrame using the same memory resource as @df, and without
+   *  more capacity reserved than @df holds rows, takes the buffers of @df
+   *  over instead of moving the values.
    *  @param df %DataFrame whose data is to be move-appended to %DataFrame.
    */
   constexpr auto append(DataFrame<Ts...>&& df) -> void {
     if (this == &df) {
       return;
     }
-    if (std::get<0>(columns_).capacity() <
-        std::get<0>(columns_).size() + std::get<0>(df.columns_).size()) {
-      int numElementsAfterAppend =
-          std::get<0>(columns_).size() + std::get<0>(df.columns_).size();
-      int newCapacity =
-          1 << static_cast<int>(std::ceil(std::log2(numElementsAfterAppend)));
-      impl::ReserveColumns(columns_, newCapacity,
-                           std::make_index_sequence<NumCols>{});
+    if (size() == 0 && capacity() <= df.size() &&
+        get_allocator() == df.get_allocator()) {
+      impl::SwapColumns(columns_, df.columns_,
+                        std::make_index_sequence<NumCols>{});
+      impl::ClearColumns(df.columns_, std::make_index_sequence<NumCols>{});
+    } else {
+      reserveForAppend(std::get<0>(df.columns_).size());
+      impl::MoveAppend(std::move(df.columns_), columns_,
+                       std::make_index_sequence<NumCols>{});
+    }
+    ++df.generation_;
+  }
+
+  /**
+   *  @brief Append one row per element of the given column buffers. All the
+   *  buffers must have the same length; each column is grown at most once.
+   *  @param cols Contiguous data for each column, in column order.
+   */
+  constexpr auto appendColumns(std::span<impl::ColumnValue<Ts> const>... cols)
+      -> void {
+    std::size_t const numRows = std::get<0>(std::tie(cols...)).size();
+    assert(((cols.size() == numRows) && ...));
+    reserveForAppend(numRows);
+    impl::AppendColumns(columns_, std::tie(cols...),
+                        std::make_index_sequence<NumCols>{});
+  }
+
+  /**
+   * @brief Get a read/write view over the contiguous data of column @Col.
+   */
+  template <std::size_t Col>
+  constexpr auto column() noexcept -> std::span<ValueType<Col>> {
+    static_assert(impl::IsContiguous<ColumnParam<Col>>,
+                  "bool, df::str and df::Categorical columns are not "
+                  "contiguous");
+    return std::get<Col>(columns_);
+  }
+
+  /**
+   * @brief Get a read-only view over the contiguous data of column @Col.
+   */
+  template <std::size_t Col>
+  constexpr auto column() const noexcept -> std::span<ValueType<Col> const> {
+    static_assert(impl::IsContiguous<ColumnParam<Col>>,
+                  "bool, df::str and df::Categorical columns are not "
+                  "contiguous");
+    return std::get<Col>(columns_);
+  }
+
+  /**
+   * @brief Get a read-only view over the codes of the categorical column
+   * @Col, which index the values returned by category<Col>().
+   */
+  template <std::size_t Col>
+  auto codes() const noexcept
+      -> std::span<typename ColType<Col>::code_type const> {
+    static_assert(impl::IsCategorical<ColumnParam<Col>>,
+                  "Only df::Categorical columns have codes");
+    return std::get<Col>(columns_).codes();
+  }
+
+  /**
+   * @brief Returns the number of distinct values of the categorical column
+   * @Col.
+   */
+  template <std::size_t Col>
+  auto numCategories() const noexcept -> std::size_t {
+    static_assert(impl::IsCategorical<ColumnParam<Col>>,
+                  "Only df::Categorical columns have categories");
+    return std::get<Col>(columns_).dictionary().size();
+  }
+
+  /**
+   * @brief Returns the value of code @code of the categorical column @Col.
+   */
+  template <std::size_t Col>
+  auto category(std::size_t code) const noexcept -> ValueType<Col> {
+    static_assert(impl::IsCategorical<ColumnParam<Col>>,
+                  "Only df::Categorical columns have categories");
+    return std::get<Col>(columns_).dictionary()[code];
+  }
+
+  /**
+   * @brief Returns the number of non-null values in column @Col.
+   */
+  template <std::size_t Col>
+  constexpr auto count() const noexcept -> std::size_t {
+    return std::get<Col>(columns_).size() - nullCount<Col>();
+  }
+
+  /**
+   * @brief Returns the number of nulls in column @Col, which is zero unless
+   * the column is nullable.
+   */
+  template <std::size_t Col>
+  constexpr auto nullCount() const noexcept -> std::size_t {
+    if constexpr (impl::IsNullable<ColumnParam<Col>>) {
+      return std::get<Col>(columns_).nullCount();
+    } else {
+      return 0;
+    }
+  }
+
+  /**
+   * @brief Returns the mask of the rows whose value in column @Col is not
+   * null, copied from the validity bitmap of the column.
+   */
+  template <std::size_t Col>
+  auto notNull() const -> Mask {
+    Mask mask{std::get<Col>(columns_).size(), true};
+    auto const validity = impl::Validity(std::get<Col>(columns_));
+    std::copy(validity.begin(), validity.end(), mask.words().begin());
+    return mask;
+  }
+
+  /**
+   * @brief Returns the number of bytes holding the values of column @Col,
+   * e.g. to compare encoded columns with plain ones.
+   */
+  template <std::size_t Col>
+  auto byteSize() const noexcept -> std::size_t {
+    if constexpr (impl::IsEncoded<ColumnParam<Col>>) {
+      return std::get<Col>(columns_).byteSize();
+    } else {
+      return std::get<Col>(columns_).size() * sizeof(ValueType<Col>);
+    }
+  }
+
+  /**
+   * @brief Call @f with the values of column @Col in consecutive blocks, as
+   * `f(firstRow, values)` with `values` a span of values. Contiguous columns
+   * are passed whole; encoded columns are decoded one block of
+   * impl::EncodedBlockSize rows at a time.
+   */
+  template <std::size_t Col, typename F>
+  auto forEachBlock(F&& f) const -> void {
+    if constexpr (impl::IsEncoded<ColumnParam<Col>>) {
+      std::get<Col>(columns_).forEachBlock(f);
+    } else if (size() > 0) {
+      f(std::size_t{0}, column<Col>());
+    }
+  }
+
+  /**
+   * @brief Returns the sum of column @Col. Floating-point columns are summed
+   * with Kahan compensation, integral columns in 64-bit integers. Nulls are
+   * stored as zeros, so nullable columns are summed densely. Encoded columns
+   * are summed on their runs or packed blocks.
+   */
+  template <std::size_t Col>
+  auto sum() const noexcept -> impl::SumType<ElementType<Col>> {
+    if constexpr (impl::IsEncoded<ColumnParam<Col>>) {
+      return std::get<Col>(columns_).sum();
+    } else {
+      return impl::Sum(denseValues<Col>());
+    }
+  }
+
+  /**
+   * @brief Returns the smallest value of column @Col, skipping nulls. The
+   * column must hold a non-null value.
+   */
+  template <std::size_t Col>
+  auto min() const noexcept -> ElementType<Col> {
+    if constexpr (impl::IsEncoded<ColumnParam<Col>>) {
+      return std::get<Col>(columns_).template minMax<false>();
+    } else {
+      return impl::MinMaxValid<false>(denseValues<Col>(), validity<Col>());
+    }
+  }
+
+  /**
+   * @brief Returns the largest value of column @Col, skipping nulls. The
+   * column must hold a non-null value.
+   */
+  template <std::size_t Col>
+  auto max() const noexcept -> ElementType<Col> {
+    if constexpr (impl::IsEncoded<ColumnParam<Col>>) {
+      return std::get<Col>(columns_).template minMax<true>();
+    } else {
+      return impl::MinMaxValid<true>(denseValues<Col>(), validity<Col>());
+    }
+  }
+
+  /**
+   * @brief Returns the arithmetic mean of the non-null values of column
+   * @Col, or NaN if there are none.
+   */
+  template <std::size_t Col>
+  auto mean() const noexcept -> double {
+    return static_cast<double>(sum<Col>()) / count<Col>();
+  }
+
+  /**
+   * @brief Returns the variance of column @Col, computed in two passes.
+   *
+   * @param ddof Delta degrees of freedom: the sum of squared deviations is
+   * divided by `count() - ddof`. The default gives the sample variance.
+   * Nulls are skipped.
+   * @returns The variance, or NaN if there are no more than @ddof values.
+   */
+  template <std::size_t Col>
+  auto var(std::size_t ddof = 1) const noexcept -> double {
+    std::size_t const n = count<Col>();
+    if (n <= ddof) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    if constexpr (impl::IsEncoded<ColumnParam<Col>>) {
+      return std::get<Col>(columns_).sumSquaredDeviations(mean<Col>()) /
+             static_cast<double>(n - ddof);
+    } else {
+      return impl::SumSquaredDeviationsValid(denseValues<Col>(),
+                                             validity<Col>(), mean<Col>()) /
+             static_cast<double>(n - ddof);
     }
-    impl::MoveAppend(std::move(df.columns_), columns_,
-                     std::make_index_sequence<NumCols>{});
+  }
+
+  /**
+   * @brief Returns the sum of the values of the column expression @e, e.g.
+   * `sum(col<0>() * col<1>())`, evaluated in a single fused pass.
+   */
+  template <expr::Expression E>
+  auto sum(E const& e) const -> impl::SumType<expr::ResultType<E, Ts...>> {
+    return impl::SumExpression(e, columns_);
+  }
+
+  /**
+   * @brief Returns the smallest value of the column expression @e. The
+   * %DataFrame must not be empty.
+   */
+  template <expr::Expression E>
+  auto min(E const& e) const -> expr::ResultType<E, Ts...> {
+    assert(size() > 0);
+    return impl::MinMaxExpression<false>(e, columns_);
+  }
+
+  /**
+   * @brief Returns the largest value of the column expression @e. The
+   * %DataFrame must not be empty.
+   */
+  template <expr::Expression E>
+  auto max(E const& e) const -> expr::ResultType<E, Ts...> {
+    assert(size() > 0);
+    return impl::MinMaxExpression<true>(e, columns_);
+  }
+
+  /**
+   * @brief Returns the arithmetic mean of the column expression @e, or NaN
+   * if the %DataFrame is empty.
+   */
+  template <expr::Expression E>
+  auto mean(E const& e) const -> double {
+    return static_cast<double>(sum(e)) / std::get<0>(columns_).size();
+  }
+
+  /**
+   * @brief Returns the sum of column @Col, computed as allowed by @policy.
+   * Parallel sums combine per-chunk sums in order, so their result does not
+   * depend on the number of threads. Encoded columns are reduced
+   * sequentially.
+   */
+  template <std::size_t Col, execution::ExecutionPolicy Policy>
+  auto sum(Policy&&) const -> impl::SumType<ElementType<Col>> {
+    if constexpr (execution::ParallelExecutionPolicy<Policy> &&
+                  !impl::IsEncoded<ColumnParam<Col>>) {
+      return impl::ParallelSum(denseValues<Col>());
+    } else {
+      return sum<Col>();
+    }
+  }
+
+  /**
+   * @brief Returns the smallest value of column @Col, computed as allowed by
+   * @policy. The column must hold a non-null value. Columns holding nulls
+   * and encoded columns are reduced sequentially.
+   */
+  template <std::size_t Col, execution::ExecutionPolicy Policy>
+  auto min(Policy&&) const -> ElementType<Col> {
+    if constexpr (execution::ParallelExecutionPolicy<Policy> &&
+                  !impl::IsEncoded<ColumnParam<Col>>) {
+      if (validity<Col>().empty()) {
+        return impl::ParallelMinMax<false>(denseValues<Col>());
+      }
+    }
+    return min<Col>();
+  }
+
+  /**
+   * @brief Returns the largest value of column @Col, computed as allowed by
+   * @policy. The column must hold a non-null value. Columns holding nulls
+   * and encoded columns are reduced sequentially.
+   */
+  template <std::size_t Col, execution::ExecutionPolicy Policy>
+  auto max(Policy&&) const -> ElementType<Col> {
+    if constexpr (execution::ParallelExecutionPolicy<Policy> &&
+                  !impl::IsEncoded<ColumnParam<Col>>) {
+      if (validity<Col>().empty()) {
+        return impl::ParallelMinMax<true>(denseValues<Col>());
+      }
+    }
+    return max<Col>();
+  }
+
+  /**
+   * @brief Returns the arithmetic mean of the non-null values of column
+   * @Col, computed as allowed by @policy, or NaN if there are none.
+   */
+  template <std::size_t Col, execution::ExecutionPolicy Policy>
+  auto mean(Policy&& policy) const -> double {
+    return static_cast<double>(sum<Col>(policy)) / count<Col>();
+  }
+
+  /**
+   * @brief Returns the variance of column @Col, computed as allowed by
+   * @policy. Parallel variances read the column once, merging per-chunk
+   * moments in order. Columns holding nulls and encoded columns are reduced
+   * sequentially.
+   *
+   * @param ddof Delta degrees of freedom, as in var(std::size_t).
+   */
+  template <std::size_t Col, execution::ExecutionPolicy Policy>
+  auto var(Policy&&, std::size_t ddof = 1) const -> double {
+    if constexpr (execution::ParallelExecutionPolicy<Policy> &&
+                  !impl::IsEncoded<ColumnParam<Col>>) {
+      std::size_t const n = count<Col>();
+      if (n <= ddof) {
+        return std::numeric_limits<double>::quiet_NaN();
+      }
+      if (validity<Col>().empty()) {
+        return impl::ParallelSumSquaredDeviations(denseValues<Col>()) /
+               static_cast<double>(n - ddof);
+      }
+    }
+    return var<Col>(ddof);
+  }
+
+  /**
+   * @brief Replace every value `x` of column @Col with `f(x)`.
+   */
+  template <std::size_t Col, typename F>
+  auto transform(F&& f) -> void {
+    transform<Col>(execution::seq, std::forward<F>(f));
+  }
+
+  /**
+   * @brief Replace every value `x` of column @Col with `f(x)`, as allowed by
+   * @policy. With a parallel policy, @f is called concurrently on chunks of
+   * the column.
+   */
+  template <std::size_t Col, execution::ExecutionPolicy Policy, typename F>
+  auto transform(Policy&& policy, F&& f) -> void {
+    auto values = column<Col>();
+    impl::ForEachIndex(policy, values.size(),
+                       impl::ChunkRows(sizeof(ValueType<Col>)),
+                       [&](std::size_t i) { values[i] = f(values[i]); });
+    ++generation_;
+  }
+
+  /**
+   * @brief Returns the values of the column expression @e on every row,
+   * computed in a single fused loop.
+   */
+  template <expr::Expression E>
+  auto evaluate(E const& e) const -> std::vector<expr::ResultType<E, Ts...>> {
+    std::vector<expr::ResultType<E, Ts...>> values(size());
+    impl::EvaluateInto(e, columns_,
+                       std::span<expr::ResultType<E, Ts...>>{values});
+    return values;
+  }
+
+  /**
+   * @brief Replace the values of column @Col with those of the column
+   * expression @e, which may read column @Col itself.
+   */
+  template <std::size_t Col, expr::Expression E>
+  auto assign(E const& e) -> void {
+    impl::EvaluateInto(e, columns_, column<Col>());
+    ++generation_;
+  }
+
+  /**
+   * @brief Call @f on every row, passed as a tuple of references.
+   */
+  template <typename F>
+  auto forEachRow(F&& f) -> void {
+    forEachRow(execution::seq, std::forward<F>(f));
+  }
+
+  /**
+   * @brief Call @f on every row, passed as a tuple of references, as allowed
+   * by @policy. With a parallel policy, @f is called concurrently on chunks of
+   * rows.
+   */
+  template <execution::ExecutionPolicy Policy, typename F>
+  auto forEachRow(Policy&& policy, F&& f) -> void {
+    impl::ForEachIndex(policy, std::get<0>(columns_).size(),
+                       impl::ChunkRows((sizeof(Ts) + ...)),
+                       [&](std::size_t i) { f(get(i)); });
+  }
+
+  /**
+   * @brief Call @f on every row, passed as a tuple of const references.
+   */
+  template <typename F>
+  auto forEachRow(F&& f) const -> void {
+    forEachRow(execution::seq, std::forward<F>(f));
+  }
+
+  /**
+   * @brief Call @f on every row, passed as a tuple of const references, as
+   * allowed by @policy.
+   */
+  template <execution::ExecutionPolicy Policy, typename F>
+  auto forEachRow(Policy&& policy, F&& f) const -> void {
+    impl::ForEachIndex(policy, std::get<0>(columns_).size(),
+                       impl::ChunkRows((sizeof(Ts) + ...)),
+                       [&](std::size_t i) { f(get(i)); });
+  }
+
+  /**
+   * @brief Returns the mask of the rows whose value in column @Col satisfies
+   * @pred. Comparisons built with df::lt, df::gt, df::eq, ... are evaluated
+   * with SIMD compares where available. Run-length encoded columns evaluate
+   * @pred once per run, and packed columns skip the blocks whose bounds
+   * decide a comparison.
+   *
+   * Masks over the same %DataFrame can be combined with &, | and ~.
+   */
+  template <std::size_t Col, typename Pred>
+  auto filter(Pred const& pred) const -> Mask {
+    return impl::Filter(std::get<Col>(columns_), pred);
+  }
+
+  /**
+   * @brief Returns the mask of the rows on which the boolean column
+   * expression @e holds, e.g. `filter(col<0>() > 3 && col<1>() < 0.5f)`.
+   */
+  template <expr::Expression E>
+  auto filter(E const& e) const -> Mask {
+    return impl::FilterExpression(e, columns_);
+  }
+
+  /**
+   * @brief Returns a new %DataFrame with the rows selected by @mask, in
+   * order, allocating from the same memory resource and growing with the
+   * same policy.
+   */
+  auto where(Mask const& mask) const -> DataFrame {
+    assert(mask.size() == std::get<0>(columns_).size());
+    DataFrame df{get_allocator()};
+    df.growthPolicy_ = growthPolicy_;
+    impl::ReserveColumns(df.columns_, mask.count(),
+                         std::make_index_sequence<NumCols>{});
+    impl::AppendMaskedColumns(columns_, mask, df.columns_,
+                              std::make_index_sequence<NumCols>{});
+    return df;
+  }
+
+  /**
+   * @brief Remove the rows not selected by @mask, keeping the order of the
+   * remaining ones. Each column is compacted in place in a single pass, and
+   * the capacity is kept.
+   */
+  auto compact(Mask const& mask) -> void {
+    assert(mask.size() == std::get<0>(columns_).size());
+    impl::CompactMaskedColumns(columns_, mask,
+                               std::make_index_sequence<NumCols>{});
+    ++generation_;
+  }
+
+  /**
+   * @brief Returns a new %DataFrame with the rows @rows, in order and
+   * possibly repeated, allocating from the same memory resource and growing
+   * with the same policy.
+   *
+   * The rows are gathered column by column rather than row by row, with
+   * the values of the rows ahead prefetched, so that random accesses such as
+   * the outputs of index lookups and joins overlap their cache misses.
+   */
+  auto take(std::span<std::size_t const> rows) const -> DataFrame {
+    DataFrame df{get_allocator()};
+    df.growthPolicy_ = growthPolicy_;
+    impl::ReserveColumns(df.columns_, rows.size(),
+                         std::make_index_sequence<NumCols>{});
+    impl::GatherColumns(columns_, rows, df.columns_,
+                        std::make_index_sequence<NumCols>{});
+    return df;
+  }
+
+  /**
+   * @brief Write the i-th row of @df into row @rows[i], for every row of
+   * @df, column by column with the rows ahead prefetched; the inverse of
+   * take(). @df must not be this %DataFrame.
+   *
+   * Only frames whose columns can be assigned in place, or are categorical,
+   * can be scattered into.
+   */
+  auto scatter(std::span<std::size_t const> rows, DataFrame const& df)
+      -> void {
+    static_assert(((impl::IsAssignable<Ts> || impl::IsCategorical<Ts>) && ...),
+                  "df::str, nullable and encoded columns cannot be written "
+                  "in place");
+    assert(rows.size() == df.size());
+    assert(&df != this);
+    impl::ScatterColumns(df.columns_, rows, columns_,
+                         std::make_index_sequence<NumCols>{});
+    ++generation_;
+  }
+
+  /**
+   * @brief Returns the permutation that stably sorts the rows by column @Col
+   * in ascending order: the i-th row of the sorted %DataFrame is row
+   * argsort()[i].
+   *
+   * Arithmetic columns are sorted with an LSD radix sort, others with a
+   * stable comparison sort.
+   */
+  template <std::size_t Col>
+  auto argsort() const -> std::vector<std::size_t> {
+    return impl::ArgSort<Col>(columns_);
+  }
+
+  /**
+   * @brief Sort the rows in ascending order of column @Col, breaking ties
+   * with the columns @Cols in order. The sort is stable.
+   *
+   * The permutation is computed once from the key columns, then applied to
+   * every column with a gather.
+   */
+  template <std::size_t Col, std::size_t... Cols>
+  auto sortBy() -> void {
+    std::vector<std::size_t> const perm = impl::ArgSort<Col, Cols...>(columns_);
+    impl::PermuteColumns(columns_, perm, std::make_index_sequence<NumCols>{});
+    ++generation_;
+  }
+
+  /**
+   * @brief Group the rows by the values of the columns @Keys, for computing
+   * aggregates with GroupBy::agg(), e.g.
+   * `df.groupBy<0>().agg<agg::Sum<1>, agg::Count, agg::Max<2>>()`.
+   *
+   * The groups are computed once with a hash table. The returned object
+   * refers to this %DataFrame, which must outlive it.
+   */
+  template <std::size_t... Keys>
+  auto groupBy() const -> GroupBy<DataFrame, Keys...> {
+    static_assert(sizeof...(Keys) > 0, "groupBy() needs at least one key");
+    return GroupBy<DataFrame, Keys...>{*this};
+  }
+
+  /**
+   * @brief Returns a lazy query pipeline over the %DataFrame, e.g.
+   * `lazy().filter(col<0>() > 0).transform<1>(col<1>() * 2).sum<1>()`.
+   * See %Lazy for how the steps are fused. The pipeline refers to this
+   * %DataFrame, which must outlive it.
+   */
+  auto lazy() const {
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      return Lazy<DataFrame, impl::AllRows, expr::Column<Is>...>{
+          *this, {}, {}};
+    }(std::make_index_sequence<NumCols>{});
+  }
+
+  /**
+   * @brief Returns a hash index over column @Col for equality lookups. The
+   * index refers to this %DataFrame, which must outlive it, and follows its
+   * appends and bulk operations.
+   */
+  template <std::size_t Col>
+  auto hashIndex() const -> HashIndex<DataFrame, Col> {
+    return HashIndex<DataFrame, Col>{*this};
+  }
+
+  /**
+   * @brief Returns a sorted index over column @Col for range lookups. The
+   * index refers to this %DataFrame, which must outlive it, and follows its
+   * appends and bulk operations.
+   */
+  template <std::size_t Col>
+  auto sortedIndex() const -> SortedIndex<DataFrame, Col> {
+    return SortedIndex<DataFrame, Col>{*this};
   }
 
   /**
    * @brief Get a reference to the elements of @row.
    */
-  constexpr auto get(int row) noexcept -> RefType {
+  constexpr auto get(std::size_t row) noexcept -> RefType {
     return impl::Get(columns_, row, std::make_index_sequence<NumCols>{});
   }
 
   /**
    * @brief Get a const reference to the elements of @row.
    */
-  constexpr auto get(int row) const noexcept -> ConstRefType {
+  constexpr auto get(std::size_t row) const noexcept -> ConstRefType {
     return impl::Get(columns_, row, std::make_index_sequence<NumCols>{});
   }
 
+  /**
+   * @brief Write the %DataFrame to @path in the native columnar format, which
+   * can be mapped back with %MappedDataFrame.
+   *
+   * @param path Path of the file to create or overwrite.
+   * @throws std::system_error if the file cannot be written.
+   */
+  auto save(std::string const& path) const -> void {
+    impl::SaveColumnar(columns_, path, std::make_index_sequence<NumCols>{});
+  }
+
+  /**
+   * @brief Export the %DataFrame through the Arrow C Data Interface, as a
+   * struct array with one child per column named after its index.
+   *
+   * The columns are moved into the exported array: fixed-width columns are
+   * shared by pointer, while string and bool columns are converted once to
+   * the Arrow layout. The memory is freed by the release callbacks, so the
+   * memory resource of the %DataFrame must outlive the array.
+   *
+   * @param schema Receives the schema of the array.
+   * @param array Receives the array.
+   */
+  auto exportArrow(ArrowSchema* schema, ArrowArray* array) && -> void {
+    impl::ExportArrow(std::move(columns_), schema, array,
+                      std::make_index_sequence<NumCols>{});
+    ++generation_;
+  }
+
+  /**
+   * @brief Export a copy of the %DataFrame through the Arrow C Data
+   * Interface. See the overload for rvalues, which does not copy.
+   *
+   * @param schema Receives the schema of the array.
+   * @param array Receives the array.
+   */
+  auto exportArrow(ArrowSchema* schema, ArrowArray* array) const& -> void {
+    DataFrame{*this}.exportArrow(schema, array);
+  }
+
+  /**
+   * @brief Create a %DataFrame from an Arrow struct array with one child per
+   * column. The data is copied and both @schema and @array are released,
+   * even if an exception is thrown.
+   *
+   * @param schema Schema of the array.
+   * @param array The array.
+   * @throws std::invalid_argument if the array does not have the columns of
+   * the %DataFrame or holds null values.
+   */
+  static auto importArrow(ArrowSchema* schema, ArrowArray* array)
+      -> DataFrame {
+    DataFrame df;
+    impl::ImportArrow(schema, array, df.columns_,
+                      std::make_index_sequence<NumCols>{});
+    return df;
+  }
+
   /**
    * @brief Print out the column number, its number of elements, and its
    * elements..
@@ -280,6 +1019,45 @@ class DataFrame {
   }
 
  private:
-  std::tuple<std::vector<Ts>...> columns_;
+  /**
+   * @brief Returns the values of column @Col, with zeros in place of nulls.
+   */
+  template <std::size_t Col>
+  auto denseValues() const noexcept -> std::span<ElementType<Col> const> {
+    static_assert(impl::IsContiguous<ColumnParam<Col>> ||
+                      impl::IsNullable<ColumnParam<Col>>,
+                  "Reductions are defined over arithmetic columns");
+    return impl::DenseValues(std::get<Col>(columns_));
+  }
+
+  /**
+   * @brief Returns the validity bitmap of column @Col, empty if it holds no
+   * null.
+   */
+  template <std::size_t Col>
+  auto validity() const noexcept -> std::span<std::uint64_t const> {
+    return impl::Validity(std::get<Col>(columns_));
+  }
+
+  /**
+   * @brief Make room for @numNewRows more rows, growing the capacity as
+   * given by the growth policy.
+   */
+  constexpr auto reserveForAppend(std::size_t numNewRows) -> void {
+    std::size_t const capacity = std::get<0>(columns_).capacity();
+    std::size_t const required = std::get<0>(columns_).size() + numNewRows;
+    if (capacity < required) {
+      impl::ReserveColumns(
+          columns_, impl::GrowCapacity(capacity, required, growthPolicy_),
+          std::make_index_sequence<NumCols>{});
+    }
+  }
+
+  std::tuple<impl::Column<Ts>...> columns_;
+  /** Incremented whenever rows are removed or reordered, for indexes. */
+  std::uint64_t generation_ = 0;
+  GrowthPolicy growthPolicy_ = GrowthPolicy::Double;
+
+  friend struct impl::ColumnAccess;
 };
 }  // namespace df
@@ -20,9 +20,15 @@ namespace df {
 template <typename... Ts>
 class DataFrame;
 
+template <typename... Ts>
+class MappedDataFrame;
+
+template <typename DF, bool Const>
+class BasicRowIterator;
+
 template <typename DF>
-class RowIteratorImpl;
+using RowIteratorImpl = BasicRowIterator<DF, false>;
 
 template <typename DF>
-class ConstRowIteratorImpl;
+using ConstRowIteratorImpl = BasicRowIterator<DF, true>;
 }  // namespace df
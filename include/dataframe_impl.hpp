@@ -16,14 +16,37 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <numeric>
+#include <span>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include "column.hpp"
+
 namespace df {
 namespace impl {
+/**
+ * @brief Grants the library's loaders and algorithms direct access to the
+ * column storage of a DF. Not meant to be used by client code.
+ */
+struct ColumnAccess {
+  template <typename DF>
+  static constexpr auto Columns(DF& df) noexcept -> auto& {
+    return df.columns_;
+  }
+
+  template <typename DF>
+  static constexpr auto Generation(DF const& df) noexcept -> std::uint64_t {
+    return df.generation_;
+  }
+};
+
 /**
  * @brief Append an element to the columns.
  *
@@ -31,9 +54,10 @@ namespace impl {
  * @param em The new element.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto Append(std::tuple<std::vector<Ts>...>& columns,
-                      std::tuple<Ts const&...> const& em,
-                      std::index_sequence<Is...>) noexcept -> void {
+constexpr auto Append(std::tuple<Column<Ts>...>& columns,
+                      std::tuple<ColumnValue<Ts> const&...> const& em,
+                      std::index_sequence<Is...>)
+    noexcept(!(IsCategorical<Ts> || ...)) -> void {
   // std::cout << "Append() with std::tuple<Ts const&...> const&\n";
   (std::get<Is>(columns).push_back(std::get<Is>(em)), ...);
 }
@@ -45,9 +69,10 @@ constexpr auto Append(std::tuple<std::vector<Ts>...>& columns,
  * @param em The new element.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto Append(std::tuple<std::vector<Ts>...>& columns,
-                      std::tuple<Ts&&...>& em,
-                      std::index_sequence<Is...>) noexcept -> void {
+constexpr auto Append(std::tuple<Column<Ts>...>& columns,
+                      std::tuple<ColumnValue<Ts>&&...>& em,
+                      std::index_sequence<Is...>)
+    noexcept(!(IsCategorical<Ts> || ...)) -> void {
   // std::cout << "Append() with std::tuple<Ts&&...>&\n";
   (std::get<Is>(columns).emplace_back(std::move(std::get<Is>(em))), ...);
 }
@@ -59,9 +84,10 @@ constexpr auto Append(std::tuple<std::vector<Ts>...>& columns,
  * @param em The new element.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto Append(std::tuple<std::vector<Ts>...>& columns,
-                      std::tuple<Ts...>&& em,
-                      std::index_sequence<Is...>) noexcept -> void {
+constexpr auto Append(std::tuple<Column<Ts>...>& columns,
+                      std::tuple<ColumnValue<Ts>...>&& em,
+                      std::index_sequence<Is...>)
+    noexcept(!(IsCategorical<Ts> || ...)) -> void {
   // std::cout << "Append() with std::tuple<Ts...>&&\n";
   (std::get<Is>(columns).emplace_back(std::move(std::get<Is>(em))), ...);
 }
@@ -74,9 +100,10 @@ constexpr auto Append(std::tuple<std::vector<Ts>...>& columns,
  * @returns A tuple of references to the row elements.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto Get(std::tuple<std::vector<Ts>...>& columns, int row,
-                   std::index_sequence<Is...>) noexcept -> std::tuple<Ts&...> {
-  return std::tie(std::get<Is>(columns)[row]...);
+constexpr auto Get(std::tuple<Column<Ts>...>& columns, std::size_t row,
+                   std::index_sequence<Is...>) noexcept
+    -> std::tuple<ColumnReference<Ts>...> {
+  return {std::get<Is>(columns)[row]...};
 }
 
 /**
@@ -87,10 +114,30 @@ constexpr auto Get(std::tuple<std::vector<Ts>...>& columns, int row,
  * @returns A tuple of const references to the row elements.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto Get(std::tuple<std::vector<Ts>...> const& columns, int row,
+constexpr auto Get(std::tuple<Column<Ts>...> const& columns, std::size_t row,
                    std::index_sequence<Is...>) noexcept
-    -> std::tuple<Ts const&...> {
-  return std::tie(std::get<Is>(columns)[row]...);
+    -> std::tuple<ColumnConstReference<Ts>...> {
+  return {std::get<Is>(columns)[row]...};
+}
+
+/**
+ * @brief Appends the data of @from to @to by move.
+ *
+ * Uses a single range insert, as in CopyAppend(). Types that cannot be
+ * move-assigned are move-constructed at the end one by one.
+ *
+ * @param from The column to move from. Cleared afterwards.
+ * @param to The column to move into.
+ */
+template <typename T>
+constexpr auto MoveAppend(Column<T>& from, Column<T>& to) -> void {
+  if constexpr (std::is_move_assignable_v<T>) {
+    to.insert(std::end(to), std::make_move_iterator(std::begin(from)),
+              std::make_move_iterator(std::end(from)));
+  } else {
+    std::move(std::begin(from), std::end(from), std::back_inserter(to));
+  }
+  from.clear();
 }
 
 /**
@@ -100,49 +147,77 @@ constexpr auto Get(std::tuple<std::vector<Ts>...> const& columns, int row,
  * @param colTo The columns of the DF to move to.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto MoveAppend(std::tuple<std::vector<Ts>...>&& colFrom,
-                          std::tuple<std::vector<Ts>...>& colTo,
-                          std::index_sequence<Is...>) noexcept -> void {
-  ((std::move(std::begin(std::get<Is>(colFrom)),
-              std::end(std::get<Is>(colFrom)),
-              std::back_inserter(std::get<Is>(colTo))),
-    std::get<Is>(colFrom).clear()),
-   ...);
+constexpr auto MoveAppend(std::tuple<Column<Ts>...>&& colFrom,
+                          std::tuple<Column<Ts>...>& colTo,
+                          std::index_sequence<Is...>) -> void {
+  (MoveAppend(std::get<Is>(colFrom), std::get<Is>(colTo)), ...);
+}
+
+/**
+ * @brief Exchange the data of @a and @b, which must use equal allocators.
+ */
+template <typename... Ts, std::size_t... Is>
+constexpr auto SwapColumns(std::tuple<Column<Ts>...>& a,
+                           std::tuple<Column<Ts>...>& b,
+                           std::index_sequence<Is...>) noexcept -> void {
+  (std::get<Is>(a).swap(std::get<Is>(b)), ...);
 }
 
 /**
- * @brief Copy data from @colFrom to @colTo.
+ * @brief Appends the data of @from to @to by copy.
+ *
+ * Uses a single range insert, which lowers to a memmove for trivially
+ * copyable types. Types that cannot be copy-assigned (a requirement of
+ * `std::vector::insert`) are copy-constructed at the end one by one.
+ *
+ * @param from The range to copy from.
+ * @param to The column to copy into.
+ */
+template <typename Range, typename T>
+constexpr auto CopyAppend(Range const& from, Column<T>& to) -> void {
+  if constexpr (std::is_copy_assignable_v<T>) {
+    to.insert(std::end(to), std::begin(from), std::end(from));
+  } else {
+    std::copy(std::begin(from), std::end(from), std::back_inserter(to));
+  }
+}
+
+/**
+ * @brief Appends the data of @colFrom to @colTo by copy, one column at a time.
  *
  * @param colFrom The columns of the DF to copy from.
  * @param colTo The columns of the DF to copy into.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto CopyColumns(std::tuple<std::vector<Ts> const&...>& colFrom,
-                           std::tuple<std::vector<Ts>&...>& colTo,
-                           std::index_sequence<Is...>) noexcept -> void {
-  // std::cout << "CopyColumns()\n";
-  (std::copy(std::begin(std::get<Is>(colFrom)), std::end(std::get<Is>(colFrom)),
-             std::back_inserter(std::get<Is>(colTo))),
-   ...);
-  //((std::get<Is>(colTo) = std::move(std::get<Is>(colFrom)),
-  //  std::get<Is>(colFrom).clear()),
-  //  ...);
+constexpr auto CopyColumns(std::tuple<Column<Ts>...> const& colFrom,
+                           std::tuple<Column<Ts>...>& colTo,
+                           std::index_sequence<Is...>) -> void {
+  (CopyAppend(std::get<Is>(colFrom), std::get<Is>(colTo)), ...);
 }
 
 /**
- * @brief Move data from @colFrom to @colTo.
+ * @brief Appends the data of the column buffers @cols to @colTo by copy.
  *
- * @param colFrom The columns of the DF to move.
- * @param colTo The columns of the DF to move to.
+ * @param colTo The columns of the DF to copy into.
+ * @param cols One buffer per column, all of the same length.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto MoveColumns(std::tuple<std::vector<Ts>...>&& colFrom,
-                           std::tuple<std::vector<Ts>...>& colTo,
-                           std::index_sequence<Is...>) noexcept -> void {
-  std::cout << "MoveColumns()\n";
-  ((std::get<Is>(colTo) = std::move(std::get<Is>(colFrom)),
-    std::get<Is>(colFrom).clear()),
-   ...);
+constexpr auto AppendColumns(
+    std::tuple<Column<Ts>...>& colTo,
+    std::tuple<std::span<ColumnValue<Ts> const>&...> const& cols,
+    std::index_sequence<Is...>) -> void {
+  (CopyAppend(std::get<Is>(cols), std::get<Is>(colTo)), ...);
+}
+
+/**
+ * @brief Removes all the elements of @columns, keeping their capacity.
+ *
+ * @param columns Tuple of columns to be cleared.
+ */
+template <typename... Ts, std::size_t... Is>
+constexpr auto ClearColumns(std::tuple<Column<Ts>...>& columns,
+                            std::index_sequence<Is...>) noexcept -> void {
+  (std::get<Is>(columns).clear(), ...);
 }
 
 /**
@@ -152,7 +227,7 @@ constexpr auto MoveColumns(std::tuple<std::vector<Ts>...>&& colFrom,
  * @param newCapacity New capacity.
  */
 template <typename... Ts, std::size_t... Is>
-constexpr auto ReserveColumns(std::tuple<std::vector<Ts>...>& columns,
+constexpr auto ReserveColumns(std::tuple<Column<Ts>...>& columns,
                               std::size_t newCapacity,
                               std::index_sequence<Is...>) -> void {
   ((std::get<Is>(columns).reserve(newCapacity)), ...);
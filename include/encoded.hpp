@@ -0,0 +1,957 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+#include "mask.hpp"
+#include "reductions.hpp"
+
+namespace df {
+/**
+ * @brief Column type holding values of the arithmetic type @T run-length
+ * encoded, e.g. `DataFrame<Rle<int>, double>` for a column of IDs that
+ * repeat over long stretches of rows.
+ *
+ * Every run of equal consecutive values is stored once, with the row where
+ * it ends. Sums, minimums, maximums and filters work on the runs, touching
+ * every run once whatever its length.
+ */
+template <typename T>
+struct Rle {
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                "Run-length encoded columns hold arithmetic values");
+};
+
+/**
+ * @brief Column type holding values of the integral type @T bit-packed
+ * against a frame of reference, e.g. `DataFrame<BitPacked<std::int64_t>>`
+ * for IDs spanning a small range.
+ *
+ * Values are packed in blocks of 128: every block stores its smallest value
+ * and the difference of every value from it in as many bits as the largest
+ * difference needs. Rows are read in constant time.
+ */
+template <typename T>
+struct BitPacked {
+  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                "Bit-packed columns hold integral values");
+};
+
+/**
+ * @brief Column type holding values of the integral type @T delta-encoded,
+ * e.g. `DataFrame<Delta<std::int64_t>, double>` for monotonic timestamps.
+ *
+ * Values are packed in blocks of 128: every block stores its first value
+ * and the difference of every value from the previous one, bit-packed
+ * against the smallest difference. Regularly spaced values take no bits at
+ * all. Reading a row decodes its block up to it.
+ */
+template <typename T>
+struct Delta {
+  static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                "Delta-encoded columns hold integral values");
+};
+
+namespace impl {
+/** Number of rows of the blocks in which encoded columns are decoded. */
+inline constexpr std::size_t EncodedBlockSize = 128;
+
+/**
+ * @brief Set bits [@first, @last) of @words.
+ */
+inline auto SetBits(std::span<std::uint64_t> words, std::size_t first,
+                    std::size_t last) noexcept -> void {
+  constexpr std::size_t WordBits = 64;
+  while (first < last) {
+    std::size_t const shift = first % WordBits;
+    std::size_t const n = std::min(WordBits - shift, last - first);
+    std::uint64_t const bits = n == WordBits
+                                   ? ~std::uint64_t{0}
+                                   : ((std::uint64_t{1} << n) - 1) << shift;
+    words[first / WordBits] |= bits;
+    first += n;
+  }
+}
+
+/**
+ * @brief Outcome of a predicate over a block of values, as known from the
+ * smallest and largest of them alone.
+ */
+enum class BlockMatch { None, Some, All };
+
+/**
+ * @brief Returns whether @pred holds on none, some or all of the values of
+ * a block whose values lie in [@min, @max]. Only comparisons against a
+ * constant can be decided this way; other predicates give Some.
+ */
+template <typename T, typename Pred>
+auto MatchBlock(Pred const& pred, T min, T max) -> BlockMatch {
+  if constexpr (IsComparison<Pred>::value) {
+    bool const lo = pred(min);
+    bool const hi = pred(max);
+    if constexpr (Pred::Operator == CmpOp::Eq ||
+                  Pred::Operator == CmpOp::Ne) {
+      bool const inside = !(pred.value < min) && !(max < pred.value);
+      if (min == max) {
+        return lo ? BlockMatch::All : BlockMatch::None;
+      }
+      if (!inside) {
+        return Pred::Operator == CmpOp::Eq ? BlockMatch::None
+                                           : BlockMatch::All;
+      }
+      return BlockMatch::Some;
+    } else {
+      // Order comparisons are monotonic in the value.
+      if (lo && hi) {
+        return BlockMatch::All;
+      }
+      if (!lo && !hi) {
+        return BlockMatch::None;
+      }
+      return BlockMatch::Some;
+    }
+  } else {
+    (void)pred;
+    (void)min;
+    (void)max;
+    return BlockMatch::Some;
+  }
+}
+
+/**
+ * @brief Returns @x sign- or zero-extended to 64 bits, in which encoded
+ * columns compute differences modulo 2^64.
+ */
+template <typename T>
+constexpr auto Widen(T x) noexcept -> std::uint64_t {
+  return static_cast<std::uint64_t>(static_cast<SumType<T>>(x));
+}
+
+/**
+ * @brief Append the @n values of @values, @width bits each, to @words,
+ * starting at a new word.
+ */
+inline auto PackBits(std::uint64_t const* values, std::size_t n,
+                     unsigned width, std::pmr::vector<std::uint64_t>& words)
+    -> void {
+  constexpr std::size_t WordBits = 64;
+  if (width == 0) {
+    return;
+  }
+  std::size_t const base = words.size();
+  words.resize(base + (n * width + WordBits - 1) / WordBits, 0);
+  std::uint64_t* const out = words.data() + base;
+  for (std::size_t k = 0; k < n; ++k) {
+    std::size_t const pos = k * width;
+    std::size_t const shift = pos % WordBits;
+    out[pos / WordBits] |= values[k] << shift;
+    if (shift + width > WordBits) {
+      out[pos / WordBits + 1] |= values[k] >> (WordBits - shift);
+    }
+  }
+}
+
+/**
+ * @brief Returns the @k-th value of @width bits packed at @words.
+ */
+inline auto UnpackBits(std::uint64_t const* words, unsigned width,
+                       std::size_t k) noexcept -> std::uint64_t {
+  constexpr std::size_t WordBits = 64;
+  if (width == 0) {
+    return 0;
+  }
+  std::size_t const pos = k * width;
+  std::size_t const shift = pos % WordBits;
+  std::uint64_t bits = words[pos / WordBits] >> shift;
+  if (shift + width > WordBits) {
+    bits |= words[pos / WordBits + 1] << (WordBits - shift);
+  }
+  return width == WordBits ? bits
+                           : bits & ((std::uint64_t{1} << width) - 1);
+}
+
+/**
+ * @brief Frame-of-reference encoding of the blocks of df::BitPacked
+ * columns: every value is stored as its difference from the smallest value
+ * of its block.
+ */
+template <typename T>
+struct FrameOfReference {
+  struct Header {
+    T min;
+    T max;
+    unsigned width;
+    /** Index of the first word of the packed differences. */
+    std::size_t word;
+  };
+
+  static auto Encode(T const* values, std::pmr::vector<std::uint64_t>& words)
+      -> Header {
+    auto const [min, max] = std::minmax_element(values, values + Size);
+    Header header{*min, *max, 0, words.size()};
+    std::uint64_t offsets[Size];
+    for (std::size_t k = 0; k < Size; ++k) {
+      offsets[k] = Widen(values[k]) - Widen(header.min);
+    }
+    header.width = std::bit_width(Widen(header.max) - Widen(header.min));
+    PackBits(offsets, Size, header.width, words);
+    return header;
+  }
+
+  static auto Decode(Header const& header, std::uint64_t const* words,
+                     T* out) noexcept -> void {
+    std::uint64_t const min = Widen(header.min);
+    for (std::size_t k = 0; k < Size; ++k) {
+      out[k] = static_cast<T>(min + UnpackBits(words, header.width, k));
+    }
+  }
+
+  static auto Get(Header const& header, std::uint64_t const* words,
+                  std::size_t k) noexcept -> T {
+    return static_cast<T>(Widen(header.min) +
+                          UnpackBits(words, header.width, k));
+  }
+
+  /**
+   * @brief Returns the sum of the values of a block: the sum of the
+   * differences, plus the smallest value once per row.
+   */
+  static auto Sum(Header const& header, std::uint64_t const* words) noexcept
+      -> SumType<T> {
+    std::uint64_t sum = Size * Widen(header.min);
+    for (std::size_t k = 0; k < Size; ++k) {
+      sum += UnpackBits(words, header.width, k);
+    }
+    return static_cast<SumType<T>>(sum);
+  }
+
+  static constexpr std::size_t Size = EncodedBlockSize;
+};
+
+/**
+ * @brief Delta encoding of the blocks of df::Delta columns: every value
+ * after the first one of its block is stored as its difference from the
+ * previous value, minus the smallest such difference in the block.
+ */
+template <typename T>
+struct DeltaOfReference {
+  struct Header {
+    T min;
+    T max;
+    T first;
+    /** Smallest difference between consecutive values, modulo 2^64. */
+    std::uint64_t step;
+    unsigned width;
+    /** Index of the first word of the packed differences. */
+    std::size_t word;
+  };
+
+  static auto Encode(T const* values, std::pmr::vector<std::uint64_t>& words)
+      -> Header {
+    auto const [min, max] = std::minmax_element(values, values + Size);
+    Header header{*min, *max, values[0], 0, 0, words.size()};
+    std::uint64_t deltas[Size - 1];
+    std::int64_t step = 0;
+    for (std::size_t k = 1; k < Size; ++k) {
+      deltas[k - 1] = Widen(values[k]) - Widen(values[k - 1]);
+      auto const delta = static_cast<std::int64_t>(deltas[k - 1]);
+      step = k == 1 ? delta : std::min(step, delta);
+    }
+    header.step = static_cast<std::uint64_t>(step);
+    std::uint64_t spread = 0;
+    for (auto& delta : deltas) {
+      delta -= header.step;
+      spread |= delta;
+    }
+    header.width = std::bit_width(spread);
+    PackBits(deltas, Size - 1, header.width, words);
+    return header;
+  }
+
+  static auto Decode(Header const& header, std::uint64_t const* words,
+                     T* out) noexcept -> void {
+    std::uint64_t x = Widen(header.first);
+    out[0] = header.first;
+    for (std::size_t k = 1; k < Size; ++k) {
+      x += header.step + UnpackBits(words, header.width, k - 1);
+      out[k] = static_cast<T>(x);
+    }
+  }
+
+  /**
+   * @brief Returns the @k-th value of a block, in constant time if its
+   * values are regularly spaced and in O(@k) otherwise.
+   */
+  static auto Get(Header const& header, std::uint64_t const* words,
+                  std::size_t k) noexcept -> T {
+    std::uint64_t x = Widen(header.first) + k * header.step;
+    for (std::size_t j = 0; header.width != 0 && j < k; ++j) {
+      x += UnpackBits(words, header.width, j);
+    }
+    return static_cast<T>(x);
+  }
+
+  /**
+   * @brief Returns the sum of the values of a block, computed from the
+   * differences without decoding the values: the j-th difference is added
+   * to every value after it.
+   */
+  static auto Sum(Header const& header, std::uint64_t const* words) noexcept
+      -> SumType<T> {
+    std::uint64_t sum = Size * Widen(header.first) +
+                        (Size * (Size - 1) / 2) * header.step;
+    for (std::size_t j = 0; header.width != 0 && j + 1 < Size; ++j) {
+      sum += (Size - 1 - j) * UnpackBits(words, header.width, j);
+    }
+    return static_cast<SumType<T>>(sum);
+  }
+
+  static constexpr std::size_t Size = EncodedBlockSize;
+};
+
+/**
+ * @brief Storage of a column of df::Rle: the value of every run and the row
+ * where it ends (exclusive), in increasing order. Values can only be
+ * appended at the end; reading a row looks its run up with a binary search.
+ */
+template <typename T>
+class Column<Rle<T>> {
+ public:
+  using value_type = T;
+  using reference = T;
+  using const_reference = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  using const_iterator = ColumnIterator<Column>;
+  using iterator = const_iterator;
+
+  static constexpr std::size_t BlockSize = EncodedBlockSize;
+
+  Column() noexcept = default;
+
+  explicit Column(allocator_type alloc) noexcept
+      : values_{alloc}, ends_{alloc} {}
+
+  Column(Column const& other) = default;
+
+  Column(Column const& other, allocator_type alloc)
+      : values_{other.values_, alloc},
+        ends_{other.ends_, alloc},
+        capacity_{other.capacity_} {}
+
+  Column(Column&& other) noexcept
+      : values_{std::move(other.values_)},
+        ends_{std::move(other.ends_)},
+        capacity_{std::exchange(other.capacity_, 0)} {}
+
+  Column(Column&& other, allocator_type alloc)
+      : values_{std::move(other.values_), alloc},
+        ends_{std::move(other.ends_), alloc},
+        capacity_{std::exchange(other.capacity_, 0)} {}
+
+  auto operator=(Column const& other) -> Column& = default;
+
+  auto operator=(Column&& other) noexcept -> Column& {
+    Column{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  auto size() const noexcept -> std::size_t {
+    return ends_.empty() ? 0 : ends_.back();
+  }
+
+  auto empty() const noexcept -> bool { return ends_.empty(); }
+
+  /**
+   * @brief Returns the number of rows reserved, which is not related to the
+   * memory held by the runs.
+   */
+  auto capacity() const noexcept -> std::size_t {
+    return std::max(capacity_, size());
+  }
+
+  /**
+   * @brief Record room for @numValues rows. The runs grow as they are
+   * appended, since their number is not known in advance.
+   */
+  auto reserve(std::size_t numValues) noexcept -> void {
+    capacity_ = std::max(capacity_, numValues);
+  }
+
+  auto clear() noexcept -> void {
+    values_.clear();
+    ends_.clear();
+  }
+
+  auto get_allocator() const noexcept -> allocator_type {
+    return values_.get_allocator();
+  }
+
+  auto operator[](std::size_t i) const noexcept -> value_type {
+    return values_[runOf(i)];
+  }
+
+  auto begin() const noexcept -> const_iterator { return {this, 0}; }
+
+  auto end() const noexcept -> const_iterator { return {this, size()}; }
+
+  /**
+   * @brief Returns the value of every run.
+   */
+  auto runValues() const noexcept -> std::span<T const> { return values_; }
+
+  /**
+   * @brief Returns the row where every run ends, exclusive.
+   */
+  auto runEnds() const noexcept -> std::span<std::size_t const> {
+    return ends_;
+  }
+
+  /**
+   * @brief Returns the number of bytes held by the runs.
+   */
+  auto byteSize() const noexcept -> std::size_t {
+    return values_.size() * sizeof(T) + ends_.size() * sizeof(std::size_t);
+  }
+
+  /**
+   * @brief Call @f with the values of the column in consecutive blocks of
+   * BlockSize rows (fewer for the last one), as `f(firstRow, values)`.
+   */
+  template <typename F>
+  auto forEachBlock(F&& f) const -> void {
+    T block[BlockSize];
+    std::size_t first = 0;
+    std::size_t n = 0;
+    std::size_t start = 0;
+    for (std::size_t r = 0; r < values_.size(); ++r) {
+      while (start < ends_[r]) {
+        std::size_t const count = std::min(ends_[r] - start, BlockSize - n);
+        std::fill_n(block + n, count, values_[r]);
+        n += count;
+        start += count;
+        if (n == BlockSize) {
+          f(first, std::span<T const>{block, n});
+          first += n;
+          n = 0;
+        }
+      }
+    }
+    if (n > 0) {
+      f(first, std::span<T const>{block, n});
+    }
+  }
+
+  /**
+   * @brief Returns the sum of the column, adding the value of every run
+   * times its length.
+   */
+  auto sum() const noexcept -> SumType<T> {
+    if constexpr (std::is_floating_point_v<T>) {
+      KahanSum<T> acc;
+      forEachRun([&](std::size_t, std::size_t count, T value) {
+        acc.add(value * static_cast<T>(count));
+      });
+      return acc.sum;
+    } else {
+      SumType<T> sum = 0;
+      forEachRun([&](std::size_t, std::size_t count, T value) {
+        sum += static_cast<SumType<T>>(value) *
+               static_cast<SumType<T>>(count);
+      });
+      return sum;
+    }
+  }
+
+  /**
+   * @brief Returns the smallest (@Max false) or largest (@Max true) value of
+   * the non-empty column, reducing the values of the runs.
+   */
+  template <bool Max>
+  auto minMax() const noexcept -> T {
+    return MinMax<Max>(runValues());
+  }
+
+  /**
+   * @brief Returns the sum of the squared differences between the values
+   * and @mean, computed once per run.
+   */
+  auto sumSquaredDeviations(double mean) const noexcept -> double {
+    KahanSum<double> acc;
+    forEachRun([&](std::size_t, std::size_t count, T value) {
+      double const d = static_cast<double>(value) - mean;
+      acc.add(d * d * static_cast<double>(count));
+    });
+    return acc.sum;
+  }
+
+  /**
+   * @brief Returns the mask of the rows satisfying @pred, which is
+   * evaluated once per run.
+   */
+  template <typename Pred>
+  auto filter(Pred const& pred) const -> Mask {
+    Mask mask{size()};
+    forEachRun([&](std::size_t first, std::size_t count, T value) {
+      if (pred(value)) {
+        SetBits(mask.words(), first, first + count);
+      }
+    });
+    return mask;
+  }
+
+  auto push_back(T value) -> void {
+    if (!values_.empty() && values_.back() == value) {
+      ++ends_.back();
+    } else {
+      values_.push_back(value);
+      ends_.push_back(size() + 1);
+    }
+  }
+
+  /**
+   * @brief Append the value constructed from @args.
+   */
+  template <typename... Args>
+  auto emplace_back(Args&&... args) -> value_type {
+    push_back(value_type(std::forward<Args>(args)...));
+    return values_.back();
+  }
+
+  /**
+   * @brief Append the values of [@first, @last), which must not belong to
+   * this column. @pos must be end().
+   *
+   * Rows of another run-length encoded column, possibly through move
+   * iterators, are appended a run at a time.
+   */
+  template <std::input_iterator It>
+  auto insert(const_iterator pos, It first, It last) -> const_iterator {
+    assert(pos == end());
+    (void)pos;
+    std::size_t const row = size();
+    if constexpr (std::is_same_v<It, std::move_iterator<const_iterator>>) {
+      insert(pos, first.base(), last.base());
+    } else if constexpr (std::is_same_v<It, const_iterator>) {
+      appendRows(first.column(), first.row(), last.row());
+    } else {
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    }
+    return {this, row};
+  }
+
+  auto swap(Column& other) noexcept -> void {
+    values_.swap(other.values_);
+    ends_.swap(other.ends_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+ private:
+  /**
+   * @brief Returns the index of the run holding row @i.
+   */
+  auto runOf(std::size_t i) const noexcept -> std::size_t {
+    return std::upper_bound(ends_.begin(), ends_.end(), i) - ends_.begin();
+  }
+
+  /**
+   * @brief Call @f with every run, as `f(firstRow, length, value)`.
+   */
+  template <typename F>
+  auto forEachRun(F&& f) const -> void {
+    std::size_t start = 0;
+    for (std::size_t r = 0; r < values_.size(); ++r) {
+      f(start, ends_[r] - start, values_[r]);
+      start = ends_[r];
+    }
+  }
+
+  /**
+   * @brief Append the values of rows [@first, @last) of @from, merging the
+   * first run appended with the last one of the column if they are equal.
+   */
+  auto appendRows(Column const& from, std::size_t first, std::size_t last)
+      -> void {
+    assert(&from != this);
+    for (std::size_t r = first < last ? from.runOf(first) : 0; first < last;
+         ++r) {
+      std::size_t const end = std::min(from.ends_[r], last);
+      if (!values_.empty() && values_.back() == from.values_[r]) {
+        ends_.back() += end - first;
+      } else {
+        values_.push_back(from.values_[r]);
+        ends_.push_back(size() + (end - first));
+      }
+      first = end;
+    }
+  }
+
+  Column<T> values_;
+  Column<std::size_t> ends_;
+  std::size_t capacity_ = 0;
+};
+
+/**
+ * @brief Storage of a column of values of type @T packed in blocks by
+ * @Codec: the header of every full block, the words of the packed blocks,
+ * and the rows of the last, partial block, kept unpacked until it fills up.
+ * Values can only be appended at the end.
+ */
+template <typename T, typename Codec>
+class PackedColumn {
+ public:
+  using value_type = T;
+  using reference = T;
+  using const_reference = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  using const_iterator = ColumnIterator<PackedColumn>;
+  using iterator = const_iterator;
+
+  static constexpr std::size_t BlockSize = Codec::Size;
+
+  PackedColumn() noexcept = default;
+
+  explicit PackedColumn(allocator_type alloc) noexcept
+      : headers_{alloc}, words_{alloc}, tail_{alloc} {}
+
+  PackedColumn(PackedColumn const& other) = default;
+
+  PackedColumn(PackedColumn const& other, allocator_type alloc)
+      : headers_{other.headers_, alloc},
+        words_{other.words_, alloc},
+        tail_{other.tail_, alloc},
+        capacity_{other.capacity_} {}
+
+  PackedColumn(PackedColumn&& other) noexcept
+      : headers_{std::move(other.headers_)},
+        words_{std::move(other.words_)},
+        tail_{std::move(other.tail_)},
+        capacity_{std::exchange(other.capacity_, 0)} {}
+
+  PackedColumn(PackedColumn&& other, allocator_type alloc)
+      : headers_{std::move(other.headers_), alloc},
+        words_{std::move(other.words_), alloc},
+        tail_{std::move(other.tail_), alloc},
+        capacity_{std::exchange(other.capacity_, 0)} {}
+
+  auto operator=(PackedColumn const& other) -> PackedColumn& = default;
+
+  auto operator=(PackedColumn&& other) noexcept -> PackedColumn& {
+    PackedColumn{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  auto size() const noexcept -> std::size_t {
+    return headers_.size() * BlockSize + tail_.size();
+  }
+
+  auto empty() const noexcept -> bool { return size() == 0; }
+
+  /**
+   * @brief Returns the number of rows reserved, which is not related to the
+   * memory held by the packed blocks.
+   */
+  auto capacity() const noexcept -> std::size_t {
+    return std::max(capacity_, size());
+  }
+
+  /**
+   * @brief Make room for the headers of the blocks of @numValues rows. The
+   * packed words grow as blocks fill up, since their width is not known in
+   * advance.
+   */
+  auto reserve(std::size_t numValues) -> void {
+    capacity_ = std::max(capacity_, numValues);
+    headers_.reserve(numValues / BlockSize);
+  }
+
+  auto clear() noexcept -> void {
+    headers_.clear();
+    words_.clear();
+    tail_.clear();
+  }
+
+  auto get_allocator() const noexcept -> allocator_type {
+    return words_.get_allocator();
+  }
+
+  auto operator[](std::size_t i) const noexcept -> value_type {
+    std::size_t const b = i / BlockSize;
+    if (b == headers_.size()) {
+      return tail_[i % BlockSize];
+    }
+    return Codec::Get(headers_[b], words_.data() + headers_[b].word,
+                      i % BlockSize);
+  }
+
+  auto begin() const noexcept -> const_iterator { return {this, 0}; }
+
+  auto end() const noexcept -> const_iterator { return {this, size()}; }
+
+  /**
+   * @brief Returns the number of bytes held by the packed blocks, their
+   * headers and the unpacked rows.
+   */
+  auto byteSize() const noexcept -> std::size_t {
+    return headers_.size() * sizeof(Header) +
+           words_.size() * sizeof(std::uint64_t) + tail_.size() * sizeof(T);
+  }
+
+  /**
+   * @brief Call @f with the values of the column in consecutive blocks of
+   * BlockSize rows (fewer for the last one), as `f(firstRow, values)`.
+   * Packed blocks are decoded one at a time into a buffer on the stack.
+   */
+  template <typename F>
+  auto forEachBlock(F&& f) const -> void {
+    T block[BlockSize];
+    for (std::size_t b = 0; b < headers_.size(); ++b) {
+      Codec::Decode(headers_[b], words_.data() + headers_[b].word, block);
+      f(b * BlockSize, std::span<T const>{block, BlockSize});
+    }
+    if (!tail_.empty()) {
+      f(headers_.size() * BlockSize, std::span<T const>{tail_});
+    }
+  }
+
+  /**
+   * @brief Returns the sum of the column, computed on the packed
+   * differences of every block.
+   */
+  auto sum() const noexcept -> SumType<T> {
+    std::uint64_t sum = static_cast<std::uint64_t>(Sum(std::span<T const>{tail_}));
+    for (auto const& header : headers_) {
+      sum += static_cast<std::uint64_t>(
+          Codec::Sum(header, words_.data() + header.word));
+    }
+    return static_cast<SumType<T>>(sum);
+  }
+
+  /**
+   * @brief Returns the smallest (@Max false) or largest (@Max true) value of
+   * the non-empty column, read from the headers of the blocks without
+   * decoding them.
+   */
+  template <bool Max>
+  auto minMax() const noexcept -> T {
+    assert(!empty());
+    T result = tail_.empty() ? (Max ? headers_[0].max : headers_[0].min)
+                             : MinMax<Max>(std::span<T const>{tail_});
+    for (auto const& header : headers_) {
+      result = Max ? std::max(result, header.max)
+                   : std::min(result, header.min);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Returns the sum of the squared differences between the values
+   * and @mean, decoding one block at a time.
+   */
+  auto sumSquaredDeviations(double mean) const noexcept -> double {
+    KahanSum<double> acc;
+    forEachBlock([&](std::size_t, std::span<T const> values) {
+      acc.add(SumSquaredDeviations(values, mean));
+    });
+    return acc.sum;
+  }
+
+  /**
+   * @brief Returns the mask of the rows satisfying @pred. Comparisons
+   * against a constant skip the blocks whose smallest and largest values
+   * decide them; other blocks are decoded and filtered like plain columns.
+   */
+  template <typename Pred>
+  auto filter(Pred const& pred) const -> Mask {
+    Mask mask{size()};
+    auto const words = mask.words();
+    T block[BlockSize];
+    for (std::size_t b = 0; b < headers_.size(); ++b) {
+      std::size_t const first = b * BlockSize;
+      switch (MatchBlock(pred, headers_[b].min, headers_[b].max)) {
+        case BlockMatch::None:
+          break;
+        case BlockMatch::All:
+          SetBits(words, first, first + BlockSize);
+          break;
+        case BlockMatch::Some:
+          Codec::Decode(headers_[b], words_.data() + headers_[b].word,
+                        block);
+          FilterInto(std::span<T const>{block, BlockSize}, pred,
+                     words.subspan(first / Mask::WordBits));
+          break;
+      }
+    }
+    if (!tail_.empty()) {
+      FilterInto(std::span<T const>{tail_}, pred,
+                 words.subspan(headers_.size() * BlockSize / Mask::WordBits));
+    }
+    return mask;
+  }
+
+  /**
+   * @brief Append @value, packing the last block once it fills up.
+   */
+  auto push_back(T value) -> void {
+    if (tail_.capacity() < BlockSize) {
+      tail_.reserve(BlockSize);
+    }
+    tail_.push_back(value);
+    if (tail_.size() == BlockSize) {
+      headers_.push_back(Codec::Encode(tail_.data(), words_));
+      tail_.clear();
+    }
+  }
+
+  /**
+   * @brief Append the value constructed from @args.
+   */
+  template <typename... Args>
+  auto emplace_back(Args&&... args) -> value_type {
+    value_type const value = value_type(std::forward<Args>(args)...);
+    push_back(value);
+    return value;
+  }
+
+  /**
+   * @brief Append the values of [@first, @last), which must not belong to
+   * this column. @pos must be end().
+   *
+   * Rows of another column of the same type, possibly through move
+   * iterators, are decoded a block at a time, and whole blocks are copied
+   * packed when both columns are aligned on a block.
+   */
+  template <std::input_iterator It>
+  auto insert(const_iterator pos, It first, It last) -> const_iterator {
+    assert(pos == end());
+    (void)pos;
+    std::size_t const row = size();
+    if constexpr (std::is_same_v<It, std::move_iterator<const_iterator>>) {
+      insert(pos, first.base(), last.base());
+    } else if constexpr (std::is_same_v<It, const_iterator>) {
+      appendRows(first.column(), first.row(), last.row());
+    } else {
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    }
+    return {this, row};
+  }
+
+  auto swap(PackedColumn& other) noexcept -> void {
+    headers_.swap(other.headers_);
+    words_.swap(other.words_);
+    tail_.swap(other.tail_);
+    std::swap(capacity_, other.capacity_);
+  }
+
+ private:
+  using Header = typename Codec::Header;
+
+  /**
+   * @brief Append the values of rows [@first, @last) of @from.
+   */
+  auto appendRows(PackedColumn const& from, std::size_t first,
+                  std::size_t last) -> void {
+    assert(&from != this);
+    T block[BlockSize];
+    while (first < last) {
+      std::size_t const b = first / BlockSize;
+      std::size_t const k = first % BlockSize;
+      std::size_t const n = std::min(BlockSize - k, last - first);
+      if (b == from.headers_.size()) {
+        for (std::size_t i = 0; i < n; ++i) {
+          push_back(from.tail_[k + i]);
+        }
+      } else if (n == BlockSize && tail_.empty()) {
+        Header header = from.headers_[b];
+        header.word = words_.size();
+        std::size_t const end = b + 1 < from.headers_.size()
+                                    ? from.headers_[b + 1].word
+                                    : from.words_.size();
+        words_.insert(words_.end(),
+                      from.words_.begin() + from.headers_[b].word,
+                      from.words_.begin() + end);
+        headers_.push_back(header);
+      } else {
+        Codec::Decode(from.headers_[b],
+                      from.words_.data() + from.headers_[b].word, block);
+        for (std::size_t i = 0; i < n; ++i) {
+          push_back(block[k + i]);
+        }
+      }
+      first += n;
+    }
+  }
+
+  std::pmr::vector<Header> headers_;
+  std::pmr::vector<std::uint64_t> words_;
+  Column<T> tail_;
+  std::size_t capacity_ = 0;
+};
+
+template <typename T>
+class Column<BitPacked<T>> : public PackedColumn<T, FrameOfReference<T>> {
+ public:
+  using PackedColumn<T, FrameOfReference<T>>::PackedColumn;
+};
+
+template <typename T>
+class Column<Delta<T>> : public PackedColumn<T, DeltaOfReference<T>> {
+ public:
+  using PackedColumn<T, DeltaOfReference<T>>::PackedColumn;
+};
+
+template <typename T>
+inline constexpr bool IsEncoded<Rle<T>> = true;
+
+template <typename T>
+inline constexpr bool IsEncoded<BitPacked<T>> = true;
+
+template <typename T>
+inline constexpr bool IsEncoded<Delta<T>> = true;
+
+/**
+ * @brief Returns the mask of the values of the encoded column @values
+ * satisfying @pred, computed by the column on its encoded form.
+ */
+template <typename T, typename Pred>
+  requires IsEncoded<T>
+auto Filter(Column<T> const& values, Pred const& pred) -> Mask {
+  return values.filter(pred);
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,58 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <type_traits>
+
+/**
+ * Execution policies accepted by the %DataFrame algorithms, mirroring the
+ * ones of <execution> without requiring a parallel STL backend.
+ */
+namespace df {
+namespace execution {
+/**
+ * @brief Run on the calling thread only.
+ */
+struct SequencedPolicy {};
+
+/**
+ * @brief Split the rows in chunks processed by the thread pool.
+ */
+struct ParallelPolicy {};
+
+/**
+ * @brief Like ParallelPolicy, and additionally allow the iterations within a
+ * chunk to be vectorized: the callable must not synchronize.
+ */
+struct ParallelUnsequencedPolicy {};
+
+inline constexpr SequencedPolicy seq{};
+inline constexpr ParallelPolicy par{};
+inline constexpr ParallelUnsequencedPolicy par_unseq{};
+
+template <typename T>
+concept ExecutionPolicy =
+    std::is_same_v<std::remove_cvref_t<T>, SequencedPolicy> ||
+    std::is_same_v<std::remove_cvref_t<T>, ParallelPolicy> ||
+    std::is_same_v<std::remove_cvref_t<T>, ParallelUnsequencedPolicy>;
+
+template <typename T>
+concept ParallelExecutionPolicy =
+    ExecutionPolicy<T> &&
+    !std::is_same_v<std::remove_cvref_t<T>, SequencedPolicy>;
+}  // namespace execution
+}  // namespace df
@@ -0,0 +1,355 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+#include "mask.hpp"
+#include "parallel.hpp"
+#include "reductions.hpp"
+
+namespace df {
+/**
+ * @brief Column expressions, built from df::col() with arithmetic,
+ * comparison and logical operators, e.g. `col<0>() * col<2>() + 1.0f`.
+ *
+ * Expressions only describe a computation. They are evaluated by
+ * DataFrame::evaluate(), assign(), filter() and the reductions taking an
+ * expression, which bind them to the columns of a %DataFrame and compute
+ * every row in a single fused loop, without intermediate columns.
+ *
+ * Every expression type defines `bind(columns)`, which returns a function
+ * of the row index computing the value of the expression on that row.
+ */
+namespace expr {
+/**
+ * @brief Expression holding the values of column @Col.
+ */
+template <std::size_t Col>
+struct Column {
+  template <typename... Ts>
+  auto bind(std::tuple<impl::Column<Ts>...> const& columns) const {
+    using T = std::tuple_element_t<Col, std::tuple<Ts...>>;
+    if constexpr (!impl::IsContiguous<T>) {
+      return [values = &std::get<Col>(columns)](std::size_t i)
+                 -> impl::ColumnValue<T> { return (*values)[i]; };
+    } else {
+      return [values = std::get<Col>(columns).data()](
+                 std::size_t i) -> T const& { return values[i]; };
+    }
+  }
+};
+
+/**
+ * @brief Expression holding the same value on every row.
+ */
+template <typename T>
+struct Literal {
+  T value;
+
+  template <typename... Ts>
+  auto bind(std::tuple<impl::Column<Ts>...> const&) const {
+    return [value = value](std::size_t) -> T { return value; };
+  }
+};
+
+/**
+ * @brief Expression applying @Op to the values of @E.
+ */
+template <typename Op, typename E>
+struct Unary {
+  E operand;
+
+  template <typename... Ts>
+  auto bind(std::tuple<impl::Column<Ts>...> const& columns) const {
+    return [e = operand.bind(columns)](std::size_t i) { return Op{}(e(i)); };
+  }
+};
+
+/**
+ * @brief Expression applying @Op to the values of @L and @R.
+ */
+template <typename Op, typename L, typename R>
+struct Binary {
+  L lhs;
+  R rhs;
+
+  template <typename... Ts>
+  auto bind(std::tuple<impl::Column<Ts>...> const& columns) const {
+    return [l = lhs.bind(columns), r = rhs.bind(columns)](std::size_t i) {
+      return Op{}(l(i), r(i));
+    };
+  }
+};
+
+template <typename E>
+struct IsExpression : std::false_type {};
+
+template <std::size_t Col>
+struct IsExpression<Column<Col>> : std::true_type {};
+
+template <typename T>
+struct IsExpression<Literal<T>> : std::true_type {};
+
+template <typename Op, typename E>
+struct IsExpression<Unary<Op, E>> : std::true_type {};
+
+template <typename Op, typename L, typename R>
+struct IsExpression<Binary<Op, L, R>> : std::true_type {};
+
+/**
+ * @brief Satisfied by column expressions.
+ */
+template <typename E>
+concept Expression = IsExpression<std::remove_cvref_t<E>>::value;
+
+/**
+ * @brief Satisfied by the operands of the operators on expressions: other
+ * expressions and arithmetic constants.
+ */
+template <typename T>
+concept Operand =
+    Expression<T> || std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+/**
+ * @brief Type of the values of expression @E over columns of types @Ts.
+ */
+template <typename E, typename... Ts>
+using ResultType = std::remove_cvref_t<decltype(std::declval<E const&>().bind(
+    std::declval<std::tuple<impl::Column<Ts>...> const&>())(std::size_t{}))>;
+
+/**
+ * @brief Returns @e with every column replaced by the matching expression
+ * of @columns: Column<I> becomes the I-th element of @columns.
+ */
+template <std::size_t Col, typename... Es>
+constexpr auto Substitute(Column<Col> const&,
+                          std::tuple<Es...> const& columns) {
+  return std::get<Col>(columns);
+}
+
+template <typename T, typename... Es>
+constexpr auto Substitute(Literal<T> const& e, std::tuple<Es...> const&) {
+  return e;
+}
+
+template <typename Op, typename E, typename... Es>
+constexpr auto Substitute(Unary<Op, E> const& e,
+                          std::tuple<Es...> const& columns) {
+  auto operand = Substitute(e.operand, columns);
+  return Unary<Op, decltype(operand)>{operand};
+}
+
+template <typename Op, typename L, typename R, typename... Es>
+constexpr auto Substitute(Binary<Op, L, R> const& e,
+                          std::tuple<Es...> const& columns) {
+  auto lhs = Substitute(e.lhs, columns);
+  auto rhs = Substitute(e.rhs, columns);
+  return Binary<Op, decltype(lhs), decltype(rhs)>{lhs, rhs};
+}
+
+/**
+ * @brief Returns @x as an expression, wrapping constants in a Literal.
+ */
+template <Operand T>
+constexpr auto AsExpression(T const& x) {
+  if constexpr (Expression<T>) {
+    return x;
+  } else {
+    return Literal<T>{x};
+  }
+}
+
+/**
+ * @brief Logical and of two boolean values without branching, which keeps
+ * filters vectorizable.
+ */
+struct LogicalAnd {
+  constexpr auto operator()(bool a, bool b) const noexcept -> bool {
+    return a & b;
+  }
+};
+
+/**
+ * @brief Logical or of two boolean values without branching.
+ */
+struct LogicalOr {
+  constexpr auto operator()(bool a, bool b) const noexcept -> bool {
+    return a | b;
+  }
+};
+
+#define DF_EXPR_BINARY_OPERATOR(op, Op)                            \
+  template <Operand L, Operand R>                                  \
+    requires(Expression<L> || Expression<R>)                       \
+  constexpr auto operator op(L const& lhs, R const& rhs) {         \
+    return Binary<Op, decltype(AsExpression(lhs)),                 \
+                  decltype(AsExpression(rhs))>{AsExpression(lhs),  \
+                                               AsExpression(rhs)}; \
+  }
+
+DF_EXPR_BINARY_OPERATOR(+, std::plus<>)
+DF_EXPR_BINARY_OPERATOR(-, std::minus<>)
+DF_EXPR_BINARY_OPERATOR(*, std::multiplies<>)
+DF_EXPR_BINARY_OPERATOR(/, std::divides<>)
+DF_EXPR_BINARY_OPERATOR(<, std::less<>)
+DF_EXPR_BINARY_OPERATOR(<=, std::less_equal<>)
+DF_EXPR_BINARY_OPERATOR(>, std::greater<>)
+DF_EXPR_BINARY_OPERATOR(>=, std::greater_equal<>)
+DF_EXPR_BINARY_OPERATOR(==, std::equal_to<>)
+DF_EXPR_BINARY_OPERATOR(!=, std::not_equal_to<>)
+DF_EXPR_BINARY_OPERATOR(&&, LogicalAnd)
+DF_EXPR_BINARY_OPERATOR(||, LogicalOr)
+
+#undef DF_EXPR_BINARY_OPERATOR
+
+template <Expression E>
+constexpr auto operator-(E const& e) {
+  return Unary<std::negate<>, E>{e};
+}
+
+template <Expression E>
+constexpr auto operator!(E const& e) {
+  return Unary<std::logical_not<>, E>{e};
+}
+}  // namespace expr
+
+/**
+ * @brief Returns an expression holding the values of column @Col.
+ */
+template <std::size_t Col>
+constexpr auto col() noexcept -> expr::Column<Col> {
+  return {};
+}
+
+namespace impl {
+/**
+ * @brief Number of rows evaluated at a time by reductions of expressions,
+ * into a buffer that stays in the L1 cache.
+ */
+inline constexpr std::size_t ExpressionBlockRows = 1024;
+
+/**
+ * @brief Write the value of @e on every row of @columns to @out.
+ */
+template <typename E, typename... Ts, typename R>
+auto EvaluateInto(E const& e, std::tuple<Column<Ts>...> const& columns,
+                  std::span<R> out) -> void {
+  auto const f = e.bind(columns);
+  R* const data = out.data();
+  std::size_t const n = out.size();
+  DF_PRAGMA_IVDEP
+  for (std::size_t i = 0; i < n; ++i) {
+    data[i] = f(i);
+  }
+}
+
+/**
+ * @brief Call @reduce on consecutive blocks of the values of @e over
+ * @columns, evaluated into a small buffer.
+ */
+template <typename E, typename... Ts, typename Reduce>
+auto ForEachExpressionBlock(E const& e,
+                            std::tuple<Column<Ts>...> const& columns,
+                            Reduce&& reduce) -> void {
+  using R = expr::ResultType<E, Ts...>;
+  auto const f = e.bind(columns);
+  std::size_t const n = std::get<0>(columns).size();
+  R block[ExpressionBlockRows];
+  for (std::size_t b = 0; b < n; b += ExpressionBlockRows) {
+    std::size_t const size = std::min(ExpressionBlockRows, n - b);
+    DF_PRAGMA_IVDEP
+    for (std::size_t i = 0; i < size; ++i) {
+      block[i] = f(b + i);
+    }
+    reduce(std::span<R const>{block, size});
+  }
+}
+
+/**
+ * @brief Returns the sum of the values of @e over @columns, compensated like
+ * Sum().
+ */
+template <typename E, typename... Ts>
+auto SumExpression(E const& e, std::tuple<Column<Ts>...> const& columns)
+    -> SumType<expr::ResultType<E, Ts...>> {
+  using R = expr::ResultType<E, Ts...>;
+  if constexpr (std::is_floating_point_v<R>) {
+    KahanSum<R> acc;
+    ForEachExpressionBlock(e, columns,
+                           [&](std::span<R const> b) { acc.add(Sum(b)); });
+    return acc.sum;
+  } else {
+    SumType<R> sum = 0;
+    ForEachExpressionBlock(e, columns,
+                           [&](std::span<R const> b) { sum += Sum(b); });
+    return sum;
+  }
+}
+
+/**
+ * @brief Returns the smallest (@Max false) or largest (@Max true) value of
+ * @e over the non-empty @columns.
+ */
+template <bool Max, typename E, typename... Ts>
+auto MinMaxExpression(E const& e, std::tuple<Column<Ts>...> const& columns)
+    -> expr::ResultType<E, Ts...> {
+  using R = expr::ResultType<E, Ts...>;
+  R result{};
+  bool first = true;
+  ForEachExpressionBlock(e, columns, [&](std::span<R const> b) {
+    R const m = MinMax<Max>(b);
+    result = first ? m : Max ? std::max(result, m) : std::min(result, m);
+    first = false;
+  });
+  return result;
+}
+
+/**
+ * @brief Returns the mask of the rows of @columns on which the boolean
+ * expression @e holds, packing 64 rows per word without branches.
+ */
+template <typename E, typename... Ts>
+auto FilterExpression(E const& e, std::tuple<Column<Ts>...> const& columns)
+    -> Mask {
+  auto const f = e.bind(columns);
+  std::size_t const n = std::get<0>(columns).size();
+  Mask mask{n};
+  auto words = mask.words();
+  for (std::size_t w = 0; w < words.size(); ++w) {
+    std::size_t const base = w * Mask::WordBits;
+    std::size_t const size = std::min(Mask::WordBits, n - base);
+    std::uint64_t word = 0;
+    for (std::size_t k = 0; k < size; ++k) {
+      bool const selected = f(base + k);
+      word |= static_cast<std::uint64_t>(selected) << k;
+    }
+    words[w] = word;
+  }
+  return mask;
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "column.hpp"
+#include "hash.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Hint the processor to fetch the cache line holding @p, which is
+ * about to be written.
+ */
+inline auto PrefetchForWrite(void const* p) noexcept -> void {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p, 1);
+#else
+  (void)p;
+#endif
+}
+
+/**
+ * @brief Append to @to the values of the rows @rows of @from, in order.
+ *
+ * Contiguous columns read their arrays directly, prefetching the values
+ * PrefetchDistance rows ahead, and categorical columns gather their codes
+ * the same way. Other columns append the values returned by `operator[]`.
+ */
+template <typename T>
+auto Gather(Column<T> const& from, std::span<std::size_t const> rows,
+            Column<T>& to) -> void {
+  std::size_t const n = rows.size();
+  if constexpr (IsCategorical<T>) {
+    auto const codes = to.mapDictionary(from);
+    auto const* in = from.codes().data();
+    auto& out = to.codes();
+    out.reserve(out.size() + n);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i + PrefetchDistance < n) {
+        Prefetch(in + rows[i + PrefetchDistance]);
+      }
+      assert(rows[i] < from.size());
+      out.push_back(codes[in[rows[i]]]);
+    }
+  } else if constexpr (IsContiguous<T>) {
+    auto const* in = from.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i + PrefetchDistance < n) {
+        Prefetch(in + rows[i + PrefetchDistance]);
+      }
+      assert(rows[i] < from.size());
+      to.push_back(in[rows[i]]);
+    }
+  } else {
+    for (std::size_t row : rows) {
+      assert(row < from.size());
+      to.push_back(from[row]);
+    }
+  }
+}
+
+/**
+ * @brief Write the i-th value of @from into row @rows[i] of @to, for every
+ * i. Values written to the same row more than once keep the last one.
+ *
+ * The values of @to PrefetchDistance rows ahead are prefetched for writing
+ * when the column is contiguous; categorical columns write their codes.
+ */
+template <typename T>
+auto Scatter(Column<T> const& from, std::span<std::size_t const> rows,
+             Column<T>& to) -> void {
+  assert(from.size() == rows.size());
+  std::size_t const n = rows.size();
+  if constexpr (IsCategorical<T>) {
+    auto const codes = to.mapDictionary(from);
+    auto* out = to.codes().data();
+    for (std::size_t i = 0; i < n; ++i) {
+      if (i + PrefetchDistance < n) {
+        PrefetchForWrite(out + rows[i + PrefetchDistance]);
+      }
+      assert(rows[i] < to.size());
+      out[rows[i]] = codes[from.code(i)];
+    }
+  } else {
+    for (std::size_t i = 0; i < n; ++i) {
+      if constexpr (IsContiguous<T>) {
+        if (i + PrefetchDistance < n) {
+          PrefetchForWrite(to.data() + rows[i + PrefetchDistance]);
+        }
+      }
+      assert(rows[i] < to.size());
+      to[rows[i]] = from[i];
+    }
+  }
+}
+
+template <typename... Ts, std::size_t... Is>
+auto GatherColumns(std::tuple<Column<Ts>...> const& from,
+                   std::span<std::size_t const> rows,
+                   std::tuple<Column<Ts>...>& to, std::index_sequence<Is...>)
+    -> void {
+  (Gather(std::get<Is>(from), rows, std::get<Is>(to)), ...);
+}
+
+template <typename... Ts, std::size_t... Is>
+auto ScatterColumns(std::tuple<Column<Ts>...> const& from,
+                    std::span<std::size_t const> rows,
+                    std::tuple<Column<Ts>...>& to, std::index_sequence<Is...>)
+    -> void {
+  (Scatter(std::get<Is>(from), rows, std::get<Is>(to)), ...);
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,298 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dataframe_fwd.hpp"
+#include "dataframe_impl.hpp"
+#include "hash.hpp"
+#include "nullable.hpp"
+#include "reductions.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Assignment of the rows of a %DataFrame to groups of equal keys.
+ * Groups are numbered in order of first appearance.
+ */
+struct Groups {
+  /** Group of every row. */
+  std::vector<std::uint32_t> ofRow;
+  /** First row of every group. */
+  std::vector<std::size_t> firstRow;
+
+  auto size() const noexcept -> std::size_t { return firstRow.size(); }
+};
+
+/**
+ * @brief Group the rows of @columns by the values of the columns @Keys.
+ *
+ * The keys are hashed column by column first, which lets the probe loop
+ * prefetch the slots of the rows ahead.
+ *
+ * @param table Receives the ids of the keys, which are the groups.
+ */
+template <std::size_t... Keys, typename... Ts>
+auto BuildGroups(
+    std::tuple<Column<Ts>...> const& columns,
+    KeyTable<std::tuple_element_t<Keys, std::tuple<Ts...>>...>& table)
+    -> Groups {
+  using Table = KeyTable<std::tuple_element_t<Keys, std::tuple<Ts...>>...>;
+  std::size_t const n = std::get<0>(columns).size();
+  std::vector<std::uint64_t> hashes(n);
+  (CombineHashes(std::get<Keys>(columns), hashes), ...);
+
+  Groups groups;
+  groups.ofRow.resize(n);
+  auto const keysOf = [&](std::uint32_t group) {
+    std::size_t const first = groups.firstRow[group];
+    return typename Table::KeyRefs{KeyOf(std::get<Keys>(columns), first)...};
+  };
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i + PrefetchDistance < n) {
+      table.prefetch(hashes[i + PrefetchDistance]);
+    }
+    typename Table::KeyRefs const keys{KeyOf(std::get<Keys>(columns), i)...};
+    auto const [group, inserted] = table.insert(hashes[i], keys, keysOf);
+    if (inserted) {
+      groups.firstRow.push_back(i);
+    }
+    groups.ofRow[i] = group;
+  }
+  return groups;
+}
+
+/**
+ * @brief Group the rows of @columns by the values of the columns @Keys.
+ */
+template <std::size_t... Keys, typename... Ts>
+auto BuildGroups(std::tuple<Column<Ts>...> const& columns) -> Groups {
+  KeyTable<std::tuple_element_t<Keys, std::tuple<Ts...>>...> table{
+      std::get<0>(columns).size() / 16};
+  return BuildGroups<Keys...>(columns, table);
+}
+}  // namespace impl
+
+/**
+ * @brief Aggregates computed by GroupBy::agg(). Each one turns a column of
+ * the grouped %DataFrame into one column of results, with one value per
+ * group, in a single pass.
+ */
+namespace agg {
+/**
+ * @brief Number of rows in each group.
+ */
+struct Count {
+  template <typename... Ts>
+  using ResultType = std::size_t;
+
+  template <typename... Ts>
+  static auto Compute(std::tuple<impl::Column<Ts>...> const&,
+                      impl::Groups const& groups)
+      -> impl::Column<std::size_t> {
+    impl::Column<std::size_t> counts(groups.size());
+    for (std::uint32_t g : groups.ofRow) {
+      ++counts[g];
+    }
+    return counts;
+  }
+};
+
+/**
+ * @brief Sum of column @Col in each group, of the type of DataFrame::sum().
+ * Nulls are stored as zeros, so they do not contribute.
+ */
+template <std::size_t Col>
+struct Sum {
+  template <typename... Ts>
+  using ResultType = impl::SumType<
+      impl::NonNullType<std::tuple_element_t<Col, std::tuple<Ts...>>>>;
+
+  template <typename... Ts>
+  static auto Compute(std::tuple<impl::Column<Ts>...> const& columns,
+                      impl::Groups const& groups)
+      -> impl::Column<ResultType<Ts...>> {
+    auto const& values = impl::DenseValues(std::get<Col>(columns));
+    impl::Column<ResultType<Ts...>> sums(groups.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      sums[groups.ofRow[i]] += values[i];
+    }
+    return sums;
+  }
+};
+
+/**
+ * @brief Arithmetic mean of the non-null values of column @Col in each
+ * group.
+ */
+template <std::size_t Col>
+struct Mean {
+  template <typename... Ts>
+  using ResultType = double;
+
+  template <typename... Ts>
+  static auto Compute(std::tuple<impl::Column<Ts>...> const& columns,
+                      impl::Groups const& groups) -> impl::Column<double> {
+    auto const& column = std::get<Col>(columns);
+    auto const& values = impl::DenseValues(column);
+    impl::Column<double> means(groups.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      means[groups.ofRow[i]] += values[i];
+    }
+    impl::Column<std::size_t> counts = Count::Compute(columns, groups);
+    if constexpr (impl::IsNullable<
+                      std::tuple_element_t<Col, std::tuple<Ts...>>>) {
+      if (column.nullCount() > 0) {
+        for (std::size_t i = 0; i < column.size(); ++i) {
+          counts[groups.ofRow[i]] -= column.isNull(i);
+        }
+      }
+    }
+    for (std::size_t g = 0; g < means.size(); ++g) {
+      means[g] /= counts[g];
+    }
+    return means;
+  }
+};
+
+/**
+ * @brief Smallest (@Max false) or largest (@Max true) value of column @Col
+ * in each group. Nulls are skipped; groups holding only nulls get T{}.
+ */
+template <std::size_t Col, bool Max>
+struct MinMax {
+  template <typename... Ts>
+  using ResultType =
+      impl::NonNullType<std::tuple_element_t<Col, std::tuple<Ts...>>>;
+
+  template <typename... Ts>
+  static auto Compute(std::tuple<impl::Column<Ts>...> const& columns,
+                      impl::Groups const& groups)
+      -> impl::Column<ResultType<Ts...>> {
+    auto const& values = std::get<Col>(columns);
+    if constexpr (impl::IsNullable<
+                      std::tuple_element_t<Col, std::tuple<Ts...>>>) {
+      auto const& dense = values.values();
+      impl::Column<ResultType<Ts...>> result(groups.size());
+      std::vector<char> seen(groups.size());
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        if (values.isNull(i)) {
+          continue;
+        }
+        std::uint32_t const g = groups.ofRow[i];
+        if (!seen[g] || (Max ? result[g] < dense[i] : dense[i] < result[g])) {
+          result[g] = dense[i];
+          seen[g] = true;
+        }
+      }
+      return result;
+    } else {
+      impl::Column<ResultType<Ts...>> result;
+      result.reserve(groups.size());
+      for (std::size_t first : groups.firstRow) {
+        result.push_back(values[first]);
+      }
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        auto& r = result[groups.ofRow[i]];
+        if (Max ? r < values[i] : values[i] < r) {
+          r = values[i];
+        }
+      }
+      return result;
+    }
+  }
+};
+
+/**
+ * @brief Smallest value of column @Col in each group.
+ */
+template <std::size_t Col>
+using Min = MinMax<Col, false>;
+
+/**
+ * @brief Largest value of column @Col in each group.
+ */
+template <std::size_t Col>
+using Max = MinMax<Col, true>;
+}  // namespace agg
+
+template <typename DF, std::size_t... Keys>
+class GroupBy;
+
+/**
+ * @brief Rows of a %DataFrame grouped by the values of the columns @Keys,
+ * as returned by DataFrame::groupBy(). Refers to the %DataFrame, which must
+ * outlive it and not be modified meanwhile.
+ */
+template <typename... Ts, std::size_t... Keys>
+class GroupBy<DataFrame<Ts...>, Keys...> {
+ public:
+  template <std::size_t Key>
+  using KeyType = std::tuple_element_t<Key, std::tuple<Ts...>>;
+
+  explicit GroupBy(DataFrame<Ts...> const& df)
+      : columns_{impl::ColumnAccess::Columns(df)},
+        groups_{impl::BuildGroups<Keys...>(columns_)} {}
+
+  /**
+   * @brief Returns the number of groups.
+   */
+  auto size() const noexcept -> std::size_t { return groups_.size(); }
+
+  /**
+   * @brief Compute the aggregates @Aggs over every group.
+   *
+   * @returns A %DataFrame with one row per group, in order of first
+   * appearance, holding the key columns followed by one column per
+   * aggregate.
+   */
+  template <typename... Aggs>
+  auto agg() const -> DataFrame<KeyType<Keys>...,
+                                typename Aggs::template ResultType<Ts...>...> {
+    DataFrame<KeyType<Keys>..., typename Aggs::template ResultType<Ts...>...>
+        result;
+    auto& out = impl::ColumnAccess::Columns(result);
+    [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      ((std::get<Is>(out).reserve(groups_.size())), ...);
+      ((gatherKeys<Keys>(std::get<Is>(out))), ...);
+    }(std::index_sequence_for<decltype(Keys)...>{});
+    [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      ((std::get<sizeof...(Keys) + Is>(out) =
+            Aggs::Compute(columns_, groups_)),
+       ...);
+    }(std::index_sequence_for<Aggs...>{});
+    return result;
+  }
+
+ private:
+  template <std::size_t Key, typename T>
+  auto gatherKeys(impl::Column<T>& out) const -> void {
+    auto const& keys = std::get<Key>(columns_);
+    for (std::size_t first : groups_.firstRow) {
+      out.push_back(keys[first]);
+    }
+  }
+
+  std::tuple<impl::Column<Ts>...> const& columns_;
+  impl::Groups groups_;
+};
+}  // namespace df
@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <limits>
+
+namespace df {
+/**
+ * @brief How a %DataFrame grows its columns when rows are appended past its
+ * capacity.
+ */
+enum class GrowthPolicy {
+  /**
+   * Reserve exactly the rows needed. Suited to frames filled by bulk
+   * appends: appending single rows then reallocates every time.
+   */
+  Exact,
+  /** Grow the capacity by half, or to the rows needed if more. */
+  OneAndAHalf,
+  /** Round the rows needed up to the next power of two. */
+  Double,
+};
+
+namespace impl {
+/**
+ * @brief Returns the capacity a column of capacity @capacity grows to in
+ * order to hold @required rows under @policy, computed in integers. Growth
+ * that would overflow gives @required.
+ */
+constexpr auto GrowCapacity(std::size_t capacity, std::size_t required,
+                            GrowthPolicy policy) noexcept -> std::size_t {
+  constexpr std::size_t Max = std::numeric_limits<std::size_t>::max();
+  if (required <= capacity) {
+    return capacity;
+  }
+  switch (policy) {
+    case GrowthPolicy::Exact:
+      return required;
+    case GrowthPolicy::OneAndAHalf:
+      if (capacity > Max - capacity / 2) {
+        return required;
+      }
+      return std::max(capacity + capacity / 2, required);
+    case GrowthPolicy::Double:
+      if (required > Max / 2 + 1) {
+        return required;
+      }
+      return std::bit_ceil(required);
+  }
+  return required;
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,226 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Number of rows ahead whose hash table slots are prefetched while
+ * probing.
+ */
+inline constexpr std::size_t PrefetchDistance = 16;
+
+/**
+ * @brief Hint the processor to fetch the cache line holding @p.
+ */
+inline auto Prefetch(void const* p) noexcept -> void {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(p);
+#else
+  (void)p;
+#endif
+}
+
+/**
+ * @brief Mix the bits of @h so that keys differing in few bits land in
+ * different slots of a power-of-two table (the finalizer of MurmurHash3).
+ */
+constexpr auto MixHash(std::uint64_t h) noexcept -> std::uint64_t {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/**
+ * @brief Returns the hash @h combined with the hash of @value.
+ */
+template <typename T>
+auto CombineHash(std::uint64_t h, T const& value) -> std::uint64_t {
+  std::uint64_t const x = std::hash<T>{}(value);
+  return MixHash(h ^ (x + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2)));
+}
+
+/**
+ * @brief Combine into @hashes the hashes of the keys of @column, one per
+ * row.
+ */
+template <typename T>
+auto CombineHashes(Column<T> const& column,
+                   std::vector<std::uint64_t>& hashes) -> void {
+  for (std::size_t i = 0; i < hashes.size(); ++i) {
+    hashes[i] = CombineHash(hashes[i], KeyOf(column, i));
+  }
+}
+
+/**
+ * @brief Whether hash tables keyed on values of @Ks store copies of the keys
+ * in their slots, which saves a cache miss per probe, rather than comparing
+ * them with the values in the columns.
+ */
+template <typename... Ks>
+inline constexpr bool InlineKeys =
+    (std::is_arithmetic_v<Ks> && ...) && (sizeof(Ks) + ...) <= 16;
+
+/**
+ * @brief Open-addressing hash table with linear probing that assigns
+ * consecutive ids to distinct keys made of the keys of rows of columns of
+ * @Ks, as given by KeyTraits.
+ *
+ * The table does not own the keys: callers pass the hash of a key along with
+ * references to its values, and a function returning the values of the key
+ * with a given id, usually read from the first row holding it. Small
+ * arithmetic keys are also copied into the slots, so that probes do not read
+ * the columns.
+ */
+template <typename... Ks>
+class KeyTable {
+ public:
+  /** References to the values of a key, as returned by KeyOf(). */
+  using KeyRefs = std::tuple<KeyRef<Ks>...>;
+
+  static constexpr std::uint32_t NotFound =
+      std::numeric_limits<std::uint32_t>::max();
+
+  /**
+   * @brief Create a table sized for @expectedKeys keys. It grows as needed.
+   */
+  explicit KeyTable(std::size_t expectedKeys = 0)
+      : slots_(std::bit_ceil(std::max<std::size_t>(2 * expectedKeys, 16))),
+        mask_{slots_.size() - 1} {}
+
+  /**
+   * @brief Returns the number of distinct keys.
+   */
+  auto size() const noexcept -> std::size_t { return size_; }
+
+  /**
+   * @brief Prefetch the first slot probed for a key with hash @hash.
+   */
+  auto prefetch(std::uint64_t hash) const noexcept -> void {
+    Prefetch(&slots_[hash & mask_]);
+  }
+
+  /**
+   * @brief Returns the id of the key @keys with hash @hash, or NotFound.
+   * @keysOf(id) returns the KeyRefs of the key with the given id.
+   */
+  template <typename KeysOf>
+  auto find(std::uint64_t hash, KeyRefs const& keys, KeysOf&& keysOf) const
+      -> std::uint32_t {
+    Slot const& slot = slots_[probe(hash, keys, keysOf)];
+    return slot.id == 0 ? NotFound : slot.id - 1;
+  }
+
+  /**
+   * @brief Returns the id of the key @keys with hash @hash, inserting it with
+   * the next id if it is not in the table yet.
+   *
+   * @returns The id and whether the key was inserted.
+   */
+  template <typename KeysOf>
+  auto insert(std::uint64_t hash, KeyRefs const& keys, KeysOf&& keysOf)
+      -> std::pair<std::uint32_t, bool> {
+    Slot& slot = slots_[probe(hash, keys, keysOf)];
+    if (slot.id != 0) {
+      return {slot.id - 1, false};
+    }
+    assert(size_ < NotFound);
+    slot.hash = hash;
+    slot.id = static_cast<std::uint32_t>(++size_);
+    if constexpr (Inline) {
+      slot.keys = keys;
+    }
+    // Keep the load factor under 1/2.
+    if (2 * size_ > slots_.size()) {
+      grow();
+    }
+    return {static_cast<std::uint32_t>(size_ - 1), true};
+  }
+
+ private:
+  static constexpr bool Inline = InlineKeys<std::remove_cvref_t<KeyRef<Ks>>...>;
+
+  struct Slot {
+    std::uint64_t hash = 0;
+    std::uint32_t id = 0;  // 0 if the slot is empty, id + 1 otherwise.
+    [[no_unique_address]] std::conditional_t<
+        Inline, std::tuple<std::remove_cvref_t<KeyRef<Ks>>...>, std::tuple<>>
+        keys;
+  };
+
+  /**
+   * @brief Returns the slot holding @keys, or the empty slot where it would
+   * be inserted.
+   */
+  template <typename KeysOf>
+  auto probe(std::uint64_t hash, KeyRefs const& keys, KeysOf& keysOf) const
+      -> std::size_t {
+    std::size_t s = hash & mask_;
+    while (slots_[s].id != 0) {
+      Slot const& slot = slots_[s];
+      if (slot.hash == hash) {
+        if constexpr (Inline) {
+          if (slot.keys == keys) {
+            break;
+          }
+        } else if (keysOf(slot.id - 1) == keys) {
+          break;
+        }
+      }
+      s = (s + 1) & mask_;
+    }
+    return s;
+  }
+
+  auto grow() -> void {
+    std::vector<Slot> grown(2 * slots_.size());
+    mask_ = grown.size() - 1;
+    for (Slot const& slot : slots_) {
+      if (slot.id != 0) {
+        std::size_t s = slot.hash & mask_;
+        while (grown[s].id != 0) {
+          s = (s + 1) & mask_;
+        }
+        grown[s] = slot;
+      }
+    }
+    slots_.swap(grown);
+  }
+
+  std::vector<Slot> slots_;
+  std::size_t mask_;
+  std::size_t size_ = 0;
+};
+}  // namespace impl
+}  // namespace df
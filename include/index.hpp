@@ -0,0 +1,310 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <tuple>
+#include <vector>
+
+#include "dataframe_fwd.hpp"
+#include "dataframe_impl.hpp"
+#include "hash.hpp"
+#include "sort.hpp"
+
+namespace df {
+template <typename DF, std::size_t Col>
+class HashIndex;
+
+/**
+ * @brief Hash index over column @Col of a %DataFrame, for equality lookups,
+ * as returned by DataFrame::hashIndex().
+ *
+ * The index refers to the %DataFrame, which must outlive it. It follows the
+ * %DataFrame on every lookup: rows appended since the last lookup are added
+ * to the index, and it is rebuilt after operations that remove, reorder or
+ * rewrite rows: clear(), compact(), sortBy(), transform(), assign(),
+ * scatter(), exportArrow() and moves. Values modified in place through
+ * column(), get(), forEachRow() or row iterators, e.g. by `std::sort`, are
+ * not detected; call rebuild() after doing so.
+ */
+template <typename... Ts, std::size_t Col>
+class HashIndex<DataFrame<Ts...>, Col> {
+ public:
+  using KeyType = typename DataFrame<Ts...>::template ValueType<Col>;
+
+  explicit HashIndex(DataFrame<Ts...> const& df) : df_{&df} { rebuild(); }
+
+  /**
+   * @brief Returns the rows holding @key, in increasing order.
+   */
+  auto find(KeyType const& key) -> std::vector<std::size_t> {
+    std::vector<std::size_t> rows;
+    forEach(key, [&](std::size_t row) { rows.push_back(row); });
+    return rows;
+  }
+
+  /**
+   * @brief Returns the number of rows holding @key.
+   */
+  auto count(KeyType const& key) -> std::size_t {
+    std::size_t count = 0;
+    forEach(key, [&](std::size_t) { ++count; });
+    return count;
+  }
+
+  /**
+   * @brief Returns whether a row holds @key.
+   */
+  auto contains(KeyType const& key) -> bool {
+    refresh();
+    return lookup(key) != Table::NotFound;
+  }
+
+  /**
+   * @brief Call @f with every row holding @key, in increasing order.
+   */
+  template <typename F>
+  auto forEach(KeyType const& key, F&& f) -> void {
+    refresh();
+    std::uint32_t const id = lookup(key);
+    if (id == Table::NotFound) {
+      return;
+    }
+    for (std::size_t row = heads_[id]; row != NoNext; row = next_[row]) {
+      f(row);
+    }
+  }
+
+  /**
+   * @brief Rebuild the index from scratch.
+   */
+  auto rebuild() -> void {
+    table_ = Table{column().size() / 4};
+    heads_.clear();
+    tails_.clear();
+    next_.clear();
+    generation_ = impl::ColumnAccess::Generation(*df_);
+    update();
+  }
+
+ private:
+  using ColumnParam = std::tuple_element_t<Col, std::tuple<Ts...>>;
+  using Table = impl::KeyTable<ColumnParam>;
+
+  static constexpr std::size_t NoNext = std::numeric_limits<std::size_t>::max();
+
+  auto column() const -> impl::Column<ColumnParam> const& {
+    return std::get<Col>(impl::ColumnAccess::Columns(*df_));
+  }
+
+  auto keysOf() const {
+    return [this](std::uint32_t id) {
+      return typename Table::KeyRefs{impl::KeyOf(column(), heads_[id])};
+    };
+  }
+
+  /**
+   * @brief Returns the id of @key in the table, or NotFound. Categorical
+   * columns are indexed on their codes, so @key is translated to its code
+   * first.
+   */
+  auto lookup(KeyType const& key) const -> std::uint32_t {
+    if constexpr (impl::IsCategorical<ColumnParam>) {
+      using Code = typename impl::Column<ColumnParam>::code_type;
+      std::uint32_t const code = column().find(key);
+      if (code == impl::Column<ColumnParam>::NotFound) {
+        return Table::NotFound;
+      }
+      return table_.find(impl::CombineHash(0, static_cast<Code>(code)),
+                         typename Table::KeyRefs{static_cast<Code>(code)},
+                         keysOf());
+    } else {
+      return table_.find(impl::CombineHash(0, key),
+                         typename Table::KeyRefs{key}, keysOf());
+    }
+  }
+
+  /**
+   * @brief Bring the index up to date with the %DataFrame.
+   */
+  auto refresh() -> void {
+    if (impl::ColumnAccess::Generation(*df_) != generation_ ||
+        column().size() < next_.size()) {
+      rebuild();
+    } else {
+      update();
+    }
+  }
+
+  /**
+   * @brief Add the rows appended since the last update, chaining every row
+   * after the previous one with the same key.
+   */
+  auto update() -> void {
+    auto const& keys = column();
+    auto const keysOf = this->keysOf();
+    for (std::size_t row = next_.size(); row < keys.size(); ++row) {
+      auto const key = impl::KeyOf(keys, row);
+      auto const [id, inserted] =
+          table_.insert(impl::CombineHash(0, key),
+                        typename Table::KeyRefs{key}, keysOf);
+      next_.push_back(NoNext);
+      if (inserted) {
+        heads_.push_back(row);
+        tails_.push_back(row);
+      } else {
+        next_[tails_[id]] = row;
+        tails_[id] = row;
+      }
+    }
+  }
+
+  DataFrame<Ts...> const* df_;
+  std::uint64_t generation_ = 0;
+  Table table_;
+  /** First and last row holding every key. */
+  std::vector<std::size_t> heads_;
+  std::vector<std::size_t> tails_;
+  /** Next row holding the same key as every row, or NoNext. */
+  std::vector<std::size_t> next_;
+};
+
+template <typename DF, std::size_t Col>
+class SortedIndex;
+
+/**
+ * @brief Sorted index over column @Col of a %DataFrame, for range lookups,
+ * as returned by DataFrame::sortedIndex(). The index holds the rows sorted by
+ * their value in column @Col, ties in increasing row order.
+ *
+ * The index follows the %DataFrame like HashIndex: rows appended since the
+ * last lookup are sorted and merged into it, and it is rebuilt after the
+ * same operations. Values modified in place are not detected either; call
+ * rebuild() after doing so.
+ */
+template <typename... Ts, std::size_t Col>
+class SortedIndex<DataFrame<Ts...>, Col> {
+ public:
+  using KeyType = typename DataFrame<Ts...>::template ValueType<Col>;
+
+  explicit SortedIndex(DataFrame<Ts...> const& df) : df_{&df} { rebuild(); }
+
+  /**
+   * @brief Returns the rows whose value is in [@lo, @hi), in value order.
+   * The view is valid until the next lookup.
+   */
+  auto range(KeyType const& lo, KeyType const& hi)
+      -> std::span<std::size_t const> {
+    refresh();
+    auto const first = lowerBound(lo);
+    auto const last = std::max(first, lowerBound(hi));
+    return {first, last};
+  }
+
+  /**
+   * @brief Returns the rows holding @key, in increasing order. The view is
+   * valid until the next lookup.
+   */
+  auto equal(KeyType const& key) -> std::span<std::size_t const> {
+    refresh();
+    return {lowerBound(key), upperBound(key)};
+  }
+
+  /**
+   * @brief Returns all the rows, in value order. The view is valid until the
+   * next lookup.
+   */
+  auto rows() -> std::span<std::size_t const> {
+    refresh();
+    return rows_;
+  }
+
+  /**
+   * @brief Rebuild the index from scratch.
+   */
+  auto rebuild() -> void {
+    rows_.clear();
+    generation_ = impl::ColumnAccess::Generation(*df_);
+    update();
+  }
+
+ private:
+  using ColumnParam = std::tuple_element_t<Col, std::tuple<Ts...>>;
+
+  auto column() const -> impl::Column<ColumnParam> const& {
+    return std::get<Col>(impl::ColumnAccess::Columns(*df_));
+  }
+
+  auto lowerBound(KeyType const& key) const
+      -> std::vector<std::size_t>::const_iterator {
+    auto const& keys = column();
+    return std::lower_bound(
+        rows_.cbegin(), rows_.cend(), key,
+        [&](std::size_t row, KeyType const& k) { return keys[row] < k; });
+  }
+
+  auto upperBound(KeyType const& key) const
+      -> std::vector<std::size_t>::const_iterator {
+    auto const& keys = column();
+    return std::upper_bound(
+        rows_.cbegin(), rows_.cend(), key,
+        [&](KeyType const& k, std::size_t row) { return k < keys[row]; });
+  }
+
+  /**
+   * @brief Bring the index up to date with the %DataFrame.
+   */
+  auto refresh() -> void {
+    if (impl::ColumnAccess::Generation(*df_) != generation_ ||
+        column().size() < rows_.size()) {
+      rebuild();
+    } else {
+      update();
+    }
+  }
+
+  /**
+   * @brief Sort the rows appended since the last update and merge them into
+   * the index. Appended rows come after the indexed ones, so a stable merge
+   * keeps ties in row order.
+   */
+  auto update() -> void {
+    auto const& keys = column();
+    std::size_t const numIndexed = rows_.size();
+    if (numIndexed == keys.size()) {
+      return;
+    }
+    std::vector<std::size_t> appended(keys.size() - numIndexed);
+    std::iota(appended.begin(), appended.end(), numIndexed);
+    impl::SortPermutation(keys, appended);
+    rows_.insert(rows_.end(), appended.begin(), appended.end());
+    std::inplace_merge(rows_.begin(), rows_.begin() + numIndexed, rows_.end(),
+                       [&](std::size_t a, std::size_t b) {
+                         return keys[a] < keys[b];
+                       });
+  }
+
+  DataFrame<Ts...> const* df_;
+  std::uint64_t generation_ = 0;
+  std::vector<std::size_t> rows_;
+};
+}  // namespace df
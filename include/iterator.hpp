@@ -16,202 +16,308 @@
  */
 #pragma once
 
-#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "dataframe_fwd.hpp"
 
 namespace df {
-template <typename DF>
-class RowIteratorImpl {
- public:
-  constexpr RowIteratorImpl(DF* df, int pos = 0) noexcept
-      : df_{df}, pos_{pos} {}
-
-  ~RowIteratorImpl() = default;
-
-  constexpr RowIteratorImpl(RowIteratorImpl const& it) noexcept
-      : df_{it.df_}, pos_{it.pos_} {}
+namespace impl {
+/**
+ * @brief Tuple of the values referred to by the tuple of references @Refs.
+ */
+template <typename Refs>
+struct RowValues;
 
-  constexpr auto operator=(RowIteratorImpl const& it) noexcept
-      -> RowIteratorImpl& {
-    df_ = it.df_;
-    pos_ = it.pos_;
-    return *this;
-  }
+template <typename... Rs>
+struct RowValues<std::tuple<Rs...>> {
+  using type = std::tuple<std::remove_cvref_t<Rs>...>;
+};
 
-  constexpr auto operator++() noexcept -> RowIteratorImpl& {
-    if (pos_ < df_->size()) {
-      ++pos_;
-    }
-    return *this;
-  }
+/**
+ * @brief Types of the rows of the %DataFrame @DF as seen through its row
+ * iterators, read only if @Const: `Refs`, the tuple of references to the
+ * elements of a row, and `Value`, the tuple of their values.
+ */
+template <typename DF, bool Const>
+struct RowTypes {
+  using Refs = typename DF::RefType;
+  using Value = typename DF::RowType;
+};
 
-  constexpr auto operator++(int) noexcept -> RowIteratorImpl& {
-    RowIteratorImpl ret = *this;
-    if (pos_ < df_->size()) {
-      ++pos_;
-    }
-    return ret;
-  }
+template <typename DF>
+struct RowTypes<DF, true> {
+  using Refs = typename DF::ConstRefType;
+  using Value = typename RowValues<Refs>::type;
+};
+}  // namespace impl
 
-  constexpr auto operator--() noexcept -> RowIteratorImpl& {
-    if (pos_ < df_->size()) {
-      --pos_;
-    }
-    return *this;
-  }
+/**
+ * @brief Reference to a row of a %DataFrame, returned by its row iterators:
+ * the tuple @Refs of references to the elements of the row, whose values
+ * are of type @Value.
+ *
+ * Assigning a row or a @Value to a reference writes the values into the
+ * row, and swap() exchanges the values of two rows, so that algorithms
+ * such as `std::sort` and `std::ranges::sort` can reorder rows through
+ * iterators. Rows can only be written if every column can be assigned in
+ * place, e.g. not through df::str columns nor through const iterators.
+ *
+ * Writes through row references are not seen by the %DataFrame: call
+ * rebuild() on its hash and sorted indexes after reordering or modifying
+ * rows this way.
+ */
+template <typename Refs, typename Value>
+class RowReference : public Refs {
+  static constexpr std::size_t Size = std::tuple_size_v<Refs>;
 
-  constexpr auto operator--(int) noexcept -> RowIteratorImpl& {
-    RowIteratorImpl ret = *this;
-    if (pos_ < df_->size()) {
-      --pos_;
-    }
-    return ret;
-  }
+  template <std::size_t I>
+  using Ref = std::tuple_element_t<I, Refs>;
 
-  constexpr auto operator+(int offset) const noexcept -> RowIteratorImpl {
-    RowIteratorImpl ret = *this;
-    ret.pos_ = std::min(std::max(0, ret.pos_ + offset), df_->size());
-    return ret;
-  }
+  template <std::size_t I>
+  using ElementValue = std::tuple_element_t<I, Value>;
 
-  constexpr auto operator-(int offset) const noexcept -> RowIteratorImpl {
-    RowIteratorImpl ret = *this;
-    ret.pos_ = std::min(std::max(0, ret.pos_ - offset), df_->size());
-    return ret;
-  }
+  static constexpr bool IsWritable =
+      []<std::size_t... Is>(std::index_sequence<Is...>) {
+        return ((std::is_assignable_v<Ref<Is>, ElementValue<Is>> &&
+                 !std::is_same_v<Ref<Is>, ElementValue<Is>>) &&
+                ...);
+      }(std::make_index_sequence<Size>{});
 
-  constexpr auto operator+=(int offset) noexcept -> RowIteratorImpl& {
-    pos_ = std::min(std::max(0, pos_ + offset), df_->size());
+ public:
+  constexpr explicit RowReference(Refs refs) noexcept(
+      std::is_nothrow_move_constructible_v<Refs>)
+      : Refs{std::move(refs)} {}
+
+  RowReference(RowReference const&) = default;
+
+  /**
+   * @brief Returns the tuple of references to the elements of the row.
+   */
+  constexpr auto refs() const noexcept -> Refs const& { return *this; }
+
+  /**
+   * @brief Returns a copy of the values of the row.
+   */
+  constexpr auto value() const -> Value { return Value(refs()); }
+
+  constexpr operator Value() const { return value(); }
+
+  /**
+   * @brief Write the values of the row of @other into this row.
+   */
+  constexpr auto operator=(RowReference const& other) const
+      -> RowReference const&
+    requires IsWritable
+  {
+    assign(other.refs(), std::make_index_sequence<Size>{});
     return *this;
   }
 
-  constexpr auto operator-=(int offset) noexcept -> RowIteratorImpl& {
-    pos_ = std::min(std::max(0, pos_ - offset), df_->size());
+  /**
+   * @brief Write @value into the row.
+   */
+  constexpr auto operator=(Value const& value) const -> RowReference const&
+    requires IsWritable
+  {
+    assign(value, std::make_index_sequence<Size>{});
     return *this;
   }
 
-  constexpr auto operator==(RowIteratorImpl const& it) const noexcept -> bool {
-    return (this == &it) || (df_ == it.df_ && pos_ == it.pos_);
-  }
-
-  constexpr auto operator!=(RowIteratorImpl const& it) const noexcept -> bool {
-    return !(*this == it);
+  /**
+   * @brief Move @value into the row.
+   */
+  constexpr auto operator=(Value&& value) const -> RowReference const&
+    requires IsWritable
+  {
+    assign(std::move(value), std::make_index_sequence<Size>{});
+    return *this;
   }
 
-  constexpr auto operator*() noexcept -> typename DF::RefType {
-    return df_->get(pos_);
+  /**
+   * @brief Exchange the values of the rows of @a and @b.
+   */
+  friend constexpr auto swap(RowReference const& a, RowReference const& b)
+      -> void
+    requires IsWritable
+  {
+    Value tmp = a.value();
+    a = b;
+    b = std::move(tmp);
   }
 
-  constexpr auto operator*() const noexcept -> typename DF::ConstRefType {
-    return static_cast<DF const*>(df_)->get(pos_);
+ private:
+  template <typename Tuple, std::size_t... Is>
+  constexpr auto assign(Tuple&& from, std::index_sequence<Is...>) const
+      -> void {
+    // Copies of the references, which are writable even when the
+    // references are proxies themselves, as for bool columns.
+    (
+        [&] {
+          Ref<Is> ref = std::get<Is>(refs());
+          ref = std::get<Is>(std::forward<Tuple>(from));
+        }(),
+        ...);
   }
+};
 
-  constexpr auto operator->() noexcept -> typename DF::RefType* {
-    return &df_->get(pos_);
-  }
+/**
+ * @brief Random-access iterator over the rows of the %DataFrame @DF, read
+ * only if @Const. Dereferencing returns a %RowReference to the row.
+ *
+ * The position is not bound-checked, except by assertions in debug builds.
+ * There is no `operator->`: row references are returned by value.
+ */
+template <typename DF, bool Const>
+class BasicRowIterator {
+  using DataFrameType = std::conditional_t<Const, DF const, DF>;
+  using Refs = typename impl::RowTypes<DF, Const>::Refs;
 
-  constexpr auto operator->() const noexcept ->
-      typename DF::ConstRefType const* {
-    return &static_cast<DF const*>(df_)->get(pos_);
-  }
+ public:
+  using iterator_concept = std::random_access_iterator_tag;
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = typename impl::RowTypes<DF, Const>::Value;
+  using difference_type = std::ptrdiff_t;
+  using reference = RowReference<Refs, value_type>;
+  using pointer = void;
 
- private:
-  DF* df_;
-  int pos_;
-};
+  constexpr BasicRowIterator() noexcept = default;
 
-template <typename DF>
-class ConstRowIteratorImpl {
- public:
-  ConstRowIteratorImpl(const DF* df, int pos = 0) noexcept
+  constexpr BasicRowIterator(DataFrameType* df, std::size_t pos) noexcept
       : df_{df}, pos_{pos} {}
 
-  ~ConstRowIteratorImpl() = default;
-
-  ConstRowIteratorImpl(ConstRowIteratorImpl const& it) noexcept
+  /**
+   * @brief Converts a read/write iterator to a read-only one.
+   */
+  template <bool OtherConst>
+    requires(Const && !OtherConst)
+  constexpr BasicRowIterator(
+      BasicRowIterator<DF, OtherConst> const& it) noexcept
       : df_{it.df_}, pos_{it.pos_} {}
 
-  constexpr auto operator=(ConstRowIteratorImpl const& it) noexcept
-      -> ConstRowIteratorImpl& {
-    df_ = it.df_;
-    pos_ = it.pos_;
-    return *this;
+  /** Row the iterator points to. */
+  constexpr auto row() const noexcept -> std::size_t { return pos_; }
+
+  constexpr auto operator*() const -> reference {
+    assert(pos_ < df_->size());
+    return reference{df_->get(pos_)};
+  }
+
+  constexpr auto operator[](difference_type n) const -> reference {
+    return *(*this + n);
   }
 
-  constexpr auto operator++() noexcept -> ConstRowIteratorImpl& {
-    if (pos_ < df_->size()) {
-      ++pos_;
-    }
+  constexpr auto operator++() noexcept -> BasicRowIterator& {
+    assert(pos_ < df_->size());
+    ++pos_;
     return *this;
   }
 
-  constexpr auto operator++(int) noexcept -> ConstRowIteratorImpl& {
-    ConstRowIteratorImpl ret = *this;
-    if (pos_ < df_->size()) {
-      ++pos_;
-    }
+  constexpr auto operator++(int) noexcept -> BasicRowIterator {
+    BasicRowIterator ret = *this;
+    ++*this;
     return ret;
   }
 
-  constexpr auto operator--() noexcept -> ConstRowIteratorImpl& {
-    if (pos_ > 0) {
-      --pos_;
-    }
+  constexpr auto operator--() noexcept -> BasicRowIterator& {
+    assert(pos_ > 0);
+    --pos_;
     return *this;
   }
 
-  constexpr auto operator--(int) noexcept -> ConstRowIteratorImpl& {
-    ConstRowIteratorImpl ret = *this;
-    if (pos_ > 0) {
-      --pos_;
-    }
+  constexpr auto operator--(int) noexcept -> BasicRowIterator {
+    BasicRowIterator ret = *this;
+    --*this;
     return ret;
   }
 
-  constexpr auto operator+(int offset) const noexcept -> ConstRowIteratorImpl {
-    ConstRowIteratorImpl ret = *this;
-    ret.pos_ = std::min(std::max(0, ret.pos_ + offset), df_->size());
-    return ret;
+  constexpr auto operator+=(difference_type n) noexcept -> BasicRowIterator& {
+    assert(n >= 0 ? static_cast<std::size_t>(n) <= df_->size() - pos_
+                  : static_cast<std::size_t>(-n) <= pos_);
+    pos_ += n;
+    return *this;
   }
 
-  constexpr auto operator-(int offset) noexcept -> ConstRowIteratorImpl {
-    ConstRowIteratorImpl ret = *this;
-    ret.pos_ = std::min(std::max(0, ret.pos_ - offset), df_->size());
-    return ret;
+  constexpr auto operator-=(difference_type n) noexcept -> BasicRowIterator& {
+    return *this += -n;
   }
 
-  constexpr auto operator+=(int offset) noexcept -> ConstRowIteratorImpl& {
-    pos_ = std::min(std::max(0, pos_ + offset), df_->size());
-    return *this;
+  friend constexpr auto operator+(BasicRowIterator it,
+                                  difference_type n) noexcept
+      -> BasicRowIterator {
+    return it += n;
   }
 
-  constexpr auto operator-=(int offset) noexcept -> ConstRowIteratorImpl& {
-    pos_ = std::min(std::max(0, pos_ - offset), df_->size());
-    return *this;
+  friend constexpr auto operator+(difference_type n,
+                                  BasicRowIterator it) noexcept
+      -> BasicRowIterator {
+    return it += n;
   }
 
-  constexpr auto operator==(ConstRowIteratorImpl const& it) const noexcept
-      -> bool {
-    return (this == &it) || (df_ == it.df_ && pos_ == it.pos_);
+  friend constexpr auto operator-(BasicRowIterator it,
+                                  difference_type n) noexcept
+      -> BasicRowIterator {
+    return it -= n;
   }
 
-  constexpr auto operator!=(ConstRowIteratorImpl const& it) const noexcept
-      -> bool {
-    return !(*this == it);
+  friend constexpr auto operator-(BasicRowIterator const& a,
+                                  BasicRowIterator const& b) noexcept
+      -> difference_type {
+    assert(a.df_ == b.df_);
+    return static_cast<difference_type>(a.pos_) -
+           static_cast<difference_type>(b.pos_);
   }
 
-  constexpr auto operator*() const noexcept -> typename DF::ConstRefType {
-    return df_->get(pos_);
+  friend constexpr auto operator==(BasicRowIterator const& a,
+                                   BasicRowIterator const& b) noexcept
+      -> bool {
+    assert(a.df_ == b.df_);
+    return a.pos_ == b.pos_;
   }
 
-  constexpr auto operator->() const noexcept ->
-      typename DF::ConstRefType const* {
-    return &static_cast<DF const*>(df_)->get(pos_);
+  friend constexpr auto operator<=>(BasicRowIterator const& a,
+                                    BasicRowIterator const& b) noexcept
+      -> std::strong_ordering {
+    assert(a.df_ == b.df_);
+    return a.pos_ <=> b.pos_;
   }
 
  private:
-  DF const* df_;
-  int pos_;
+  template <typename, bool>
+  friend class BasicRowIterator;
+
+  DataFrameType* df_ = nullptr;
+  std::size_t pos_ = 0;
 };
 }  // namespace df
+
+template <typename Refs, typename Value>
+struct std::tuple_size<df::RowReference<Refs, Value>>
+    : std::tuple_size<Refs> {};
+
+template <std::size_t I, typename Refs, typename Value>
+struct std::tuple_element<I, df::RowReference<Refs, Value>>
+    : std::tuple_element<I, Refs> {};
+
+/**
+ * Row references and the values of their rows have the values as common
+ * reference, as required by `std::indirectly_readable`.
+ */
+template <typename Refs, typename Value, template <typename> typename TQual,
+          template <typename> typename UQual>
+struct std::basic_common_reference<df::RowReference<Refs, Value>, Value,
+                                   TQual, UQual> {
+  using type = Value;
+};
+
+template <typename Refs, typename Value, template <typename> typename TQual,
+          template <typename> typename UQual>
+struct std::basic_common_reference<Value, df::RowReference<Refs, Value>,
+                                   TQual, UQual> {
+  using type = Value;
+};
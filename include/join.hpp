@@ -0,0 +1,507 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dataframe.hpp"
+#include "group_by.hpp"
+#include "hash.hpp"
+#include "mask.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Row index standing for a missing row in the outputs of MatchRows().
+ */
+inline constexpr std::size_t NoRow = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Type of the result of joining a %DataFrame of @Ls with one of @Rs
+ * on the column @RightKey of the latter: the left columns followed by the
+ * right columns but the key.
+ */
+template <typename L, typename R, std::size_t RightKey>
+struct JoinResult;
+
+template <typename... Ls, typename... Rs, std::size_t RightKey>
+struct JoinResult<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> {
+  static constexpr auto RightColumn(std::size_t i) noexcept -> std::size_t {
+    return i < RightKey ? i : i + 1;
+  }
+
+  template <typename Is>
+  struct Make;
+
+  template <std::size_t... Is>
+  struct Make<std::index_sequence<Is...>> {
+    using type = DataFrame<
+        Ls..., std::tuple_element_t<RightColumn(Is), std::tuple<Rs...>>...>;
+  };
+
+  using type = typename Make<std::make_index_sequence<sizeof...(Rs) - 1>>::type;
+};
+
+template <typename L, typename R, std::size_t RightKey>
+using JoinResultType = typename JoinResult<L, R, RightKey>::type;
+
+/**
+ * @brief Hash table over the key column of the build side of a join, with
+ * the rows holding each key laid out contiguously in row order.
+ */
+template <typename K>
+struct JoinTable {
+  KeyTable<K> table;
+  /** Rows holding key id are rows[offsets[id]] to rows[offsets[id + 1]]. */
+  std::vector<std::size_t> offsets;
+  std::vector<std::size_t> rows;
+};
+
+template <std::size_t Key, typename... Ts>
+auto BuildJoinTable(std::tuple<Column<Ts>...> const& columns)
+    -> JoinTable<std::tuple_element_t<Key, std::tuple<Ts...>>> {
+  JoinTable<std::tuple_element_t<Key, std::tuple<Ts...>>> build;
+  Groups const groups = BuildGroups<Key>(columns, build.table);
+  build.offsets.assign(groups.size() + 1, 0);
+  for (std::uint32_t g : groups.ofRow) {
+    ++build.offsets[g + 1];
+  }
+  for (std::size_t g = 0; g < groups.size(); ++g) {
+    build.offsets[g + 1] += build.offsets[g];
+  }
+  std::vector<std::size_t> next(build.offsets.begin(), build.offsets.end() - 1);
+  build.rows.resize(groups.ofRow.size());
+  for (std::size_t i = 0; i < groups.ofRow.size(); ++i) {
+    build.rows[next[groups.ofRow[i]]++] = i;
+  }
+  return build;
+}
+
+/**
+ * @brief Returns the id in @build of the key of every row of the column
+ * @ProbeKey of @probe, or KeyTable::NotFound. The table is probed in batches
+ * of rows whose hashes are computed first, prefetching the slots ahead.
+ *
+ * Categorical keys probe the table once per value of the dictionary of the
+ * probe column, translated to its code on the build side, then look up the
+ * id of every row by its code.
+ */
+template <std::size_t ProbeKey, std::size_t BuildKey, typename... Ps,
+          typename... Bs, typename K>
+auto ProbeJoinTable(std::tuple<Column<Ps>...> const& probe,
+                    std::tuple<Column<Bs>...> const& buildColumns,
+                    JoinTable<K> const& build) -> std::vector<std::uint32_t> {
+  static_assert(
+      std::is_same_v<std::tuple_element_t<ProbeKey, std::tuple<Ps...>>, K>,
+      "Join keys must have the same type");
+  using KeyRefs = typename KeyTable<K>::KeyRefs;
+  constexpr std::size_t BatchRows = 1024;
+  auto const& keys = std::get<ProbeKey>(probe);
+  auto const& buildKeys = std::get<BuildKey>(buildColumns);
+  auto const keysOf = [&](std::uint32_t id) {
+    return KeyRefs{KeyOf(buildKeys, build.rows[build.offsets[id]])};
+  };
+  std::vector<std::uint32_t> ids(keys.size());
+  if constexpr (IsCategorical<K>) {
+    using Code = typename Column<K>::code_type;
+    auto const& dictionary = keys.dictionary();
+    std::vector<std::uint32_t> idOf(dictionary.size(), KeyTable<K>::NotFound);
+    for (std::size_t c = 0; c < idOf.size(); ++c) {
+      std::uint32_t const code = buildKeys.find(dictionary[c]);
+      if (code != Column<K>::NotFound) {
+        idOf[c] = build.table.find(CombineHash(0, static_cast<Code>(code)),
+                                   KeyRefs{static_cast<Code>(code)}, keysOf);
+      }
+    }
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      ids[i] = idOf[keys.code(i)];
+    }
+  } else {
+    std::vector<std::uint64_t> hashes;
+    for (std::size_t b = 0; b < keys.size(); b += BatchRows) {
+      std::size_t const e = std::min(b + BatchRows, keys.size());
+      hashes.resize(e - b);
+      for (std::size_t i = b; i < e; ++i) {
+        hashes[i - b] = CombineHash(0, KeyOf(keys, i));
+      }
+      for (std::size_t i = b; i < e; ++i) {
+        if (i + PrefetchDistance < e) {
+          build.table.prefetch(hashes[i + PrefetchDistance - b]);
+        }
+        ids[i] =
+            build.table.find(hashes[i - b], KeyRefs{KeyOf(keys, i)}, keysOf);
+      }
+    }
+  }
+  return ids;
+}
+
+/**
+ * @brief Matching rows of the two sides of a join, in the order of the probe
+ * rows. Joins of sorted columns probe with the left side.
+ */
+struct MatchedRows {
+  std::vector<std::size_t> probe;
+  std::vector<std::size_t> build;
+};
+
+/**
+ * @brief Returns the pairs of rows of @probe and @build with equal keys.
+ * The outputs are sized exactly from the number of matches of every probe
+ * row, counted first.
+ *
+ * @param keepUnmatched Whether probe rows without matches are paired with
+ * NoRow.
+ */
+template <std::size_t ProbeKey, std::size_t BuildKey, typename... Ps,
+          typename... Bs>
+auto MatchRows(std::tuple<Column<Ps>...> const& probe,
+               std::tuple<Column<Bs>...> const& build, bool keepUnmatched)
+    -> MatchedRows {
+  auto const table = BuildJoinTable<BuildKey>(build);
+  std::vector<std::uint32_t> const ids =
+      ProbeJoinTable<ProbeKey, BuildKey>(probe, build, table);
+  using Table = decltype(table.table);
+  auto const numMatches = [&](std::uint32_t id) -> std::size_t {
+    return id == Table::NotFound ? 0
+                                 : table.offsets[id + 1] - table.offsets[id];
+  };
+  std::size_t total = 0;
+  for (std::uint32_t id : ids) {
+    std::size_t const n = numMatches(id);
+    total += n == 0 && keepUnmatched ? 1 : n;
+  }
+  MatchedRows matched;
+  matched.probe.reserve(total);
+  matched.build.reserve(total);
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] == Table::NotFound) {
+      if (keepUnmatched) {
+        matched.probe.push_back(i);
+        matched.build.push_back(NoRow);
+      }
+      continue;
+    }
+    for (std::size_t k = table.offsets[ids[i]]; k < table.offsets[ids[i] + 1];
+         ++k) {
+      matched.probe.push_back(i);
+      matched.build.push_back(table.rows[k]);
+    }
+  }
+  return matched;
+}
+
+/**
+ * @brief Returns the mask of the rows of @probe whose key appears in @build.
+ */
+template <std::size_t ProbeKey, std::size_t BuildKey, typename... Ps,
+          typename... Bs>
+auto MatchMask(std::tuple<Column<Ps>...> const& probe,
+               std::tuple<Column<Bs>...> const& build) -> Mask {
+  auto const table = BuildJoinTable<BuildKey>(build);
+  std::vector<std::uint32_t> const ids =
+      ProbeJoinTable<ProbeKey, BuildKey>(probe, build, table);
+  Mask mask{ids.size()};
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (ids[i] != decltype(table.table)::NotFound) {
+      mask.set(i);
+    }
+  }
+  return mask;
+}
+
+/**
+ * @brief Returns the pairs of rows of the sorted columns @left and @right
+ * with equal keys, in order, walking both columns once.
+ */
+template <typename K>
+auto MergeMatchRows(Column<K> const& left, Column<K> const& right)
+    -> MatchedRows {
+  assert(std::is_sorted(left.begin(), left.end()));
+  assert(std::is_sorted(right.begin(), right.end()));
+  MatchedRows matched;
+  std::size_t i = 0;
+  std::size_t j = 0;
+  while (i < left.size() && j < right.size()) {
+    if (left[i] < right[j]) {
+      ++i;
+    } else if (right[j] < left[i]) {
+      ++j;
+    } else {
+      // Pair the runs of equal keys on both sides.
+      std::size_t iEnd = i + 1;
+      while (iEnd < left.size() && !(left[i] < left[iEnd])) {
+        ++iEnd;
+      }
+      std::size_t jEnd = j + 1;
+      while (jEnd < right.size() && !(right[j] < right[jEnd])) {
+        ++jEnd;
+      }
+      for (; i < iEnd; ++i) {
+        for (std::size_t k = j; k < jEnd; ++k) {
+          matched.probe.push_back(i);
+          matched.build.push_back(k);
+        }
+      }
+      j = jEnd;
+    }
+  }
+  return matched;
+}
+
+/**
+ * @brief Pairs every row of the sorted column @left with the last row of the
+ * sorted column @right whose key is not greater, or with NoRow if there is
+ * none or if @withinTolerance(leftKey, rightKey) is false. Walks both columns
+ * once.
+ */
+template <typename K, typename WithinTolerance>
+auto AsofMatchRows(Column<K> const& left, Column<K> const& right,
+                   WithinTolerance const& withinTolerance) -> MatchedRows {
+  assert(std::is_sorted(left.begin(), left.end()));
+  assert(std::is_sorted(right.begin(), right.end()));
+  MatchedRows matched;
+  matched.probe.resize(left.size());
+  matched.build.resize(left.size());
+  std::size_t j = 0;
+  for (std::size_t i = 0; i < left.size(); ++i) {
+    while (j < right.size() && !(left[i] < right[j])) {
+      ++j;
+    }
+    matched.probe[i] = i;
+    matched.build[i] = j > 0 && withinTolerance(left[i], right[j - 1])
+                           ? j - 1
+                           : NoRow;
+  }
+  return matched;
+}
+
+/**
+ * @brief Append to @to the values of @from at @rows, or default-constructed
+ * values for NoRow. Categorical columns append the codes of @from,
+ * translated into the dictionary of @to.
+ */
+template <typename T>
+auto GatherOrDefault(Column<T> const& from,
+                     std::span<std::size_t const> rows, Column<T>& to)
+    -> void {
+  to.reserve(to.size() + rows.size());
+  if constexpr (IsCategorical<T>) {
+    auto const codes = to.mapDictionary(from);
+    auto& out = to.codes();
+    for (std::size_t i : rows) {
+      out.push_back(i == NoRow ? to.intern({}) : codes[from.code(i)]);
+    }
+  } else {
+    for (std::size_t i : rows) {
+      if (i == NoRow) {
+        to.emplace_back();
+      } else {
+        to.push_back(from[i]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Fill the columns of the result of a join from the matching rows of
+ * both sides.
+ */
+template <std::size_t RightKey, typename... Ls, typename... Rs,
+          typename... Os>
+auto GatherJoin(std::tuple<Column<Ls>...> const& left,
+                std::span<std::size_t const> leftRows,
+                std::tuple<Column<Rs>...> const& right,
+                std::span<std::size_t const> rightRows,
+                std::tuple<Column<Os>...>& out) -> void {
+  [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+    (GatherOrDefault(std::get<Is>(left), leftRows, std::get<Is>(out)), ...);
+  }(std::index_sequence_for<Ls...>{});
+  [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+    (GatherOrDefault(std::get<(Is < RightKey ? Is : Is + 1)>(right),
+                     rightRows, std::get<sizeof...(Ls) + Is>(out)),
+     ...);
+  }(std::make_index_sequence<sizeof...(Rs) - 1>{});
+}
+}  // namespace impl
+
+/**
+ * @brief Inner equi-join of @left and @right on the columns @LeftKey and
+ * @RightKey, which must have the same type.
+ *
+ * A hash table is built on the key column of the smaller side and probed
+ * with the other one; the rows of the result are in the order of the probe
+ * side.
+ *
+ * @returns A %DataFrame with the columns of @left followed by those of
+ * @right but @RightKey, with one row per pair of rows with equal keys.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs>
+auto innerJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right)
+    -> impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> {
+  auto const& l = impl::ColumnAccess::Columns(left);
+  auto const& r = impl::ColumnAccess::Columns(right);
+  impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> result;
+  auto& out = impl::ColumnAccess::Columns(result);
+  if (std::get<RightKey>(r).size() <= std::get<LeftKey>(l).size()) {
+    auto const matched = impl::MatchRows<LeftKey, RightKey>(l, r, false);
+    impl::GatherJoin<RightKey>(l, matched.probe, r, matched.build, out);
+  } else {
+    auto const matched = impl::MatchRows<RightKey, LeftKey>(r, l, false);
+    impl::GatherJoin<RightKey>(l, matched.build, r, matched.probe, out);
+  }
+  return result;
+}
+
+/**
+ * @brief Left outer equi-join of @left and @right on the columns @LeftKey
+ * and @RightKey, which must have the same type.
+ *
+ * A hash table is built on the key column of @right and probed with the
+ * rows of @left, in order. Rows of @left without a match appear once, with
+ * default-constructed values in the columns of @right.
+ *
+ * @returns A %DataFrame with the columns of @left followed by those of
+ * @right but @RightKey.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs>
+auto leftJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right)
+    -> impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> {
+  auto const& l = impl::ColumnAccess::Columns(left);
+  auto const& r = impl::ColumnAccess::Columns(right);
+  impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> result;
+  auto const matched = impl::MatchRows<LeftKey, RightKey>(l, r, true);
+  impl::GatherJoin<RightKey>(l, matched.probe, r, matched.build,
+                             impl::ColumnAccess::Columns(result));
+  return result;
+}
+
+/**
+ * @brief Returns the rows of @left whose key in column @LeftKey appears in
+ * column @RightKey of @right, in order.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs>
+auto semiJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right)
+    -> DataFrame<Ls...> {
+  return left.where(
+      impl::MatchMask<LeftKey, RightKey>(impl::ColumnAccess::Columns(left),
+                                         impl::ColumnAccess::Columns(right)));
+}
+
+/**
+ * @brief Returns the rows of @left whose key in column @LeftKey does not
+ * appear in column @RightKey of @right, in order.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs>
+auto antiJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right)
+    -> DataFrame<Ls...> {
+  return left.where(
+      ~impl::MatchMask<LeftKey, RightKey>(impl::ColumnAccess::Columns(left),
+                                          impl::ColumnAccess::Columns(right)));
+}
+
+/**
+ * @brief Inner equi-join of @left and @right on the columns @LeftKey and
+ * @RightKey, which must have the same type and be sorted in ascending
+ * order.
+ *
+ * Both key columns are walked once, without a hash table. The rows of the
+ * result are in key order.
+ *
+ * @returns A %DataFrame with the columns of @left followed by those of
+ * @right but @RightKey, with one row per pair of rows with equal keys.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs>
+auto mergeJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right)
+    -> impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> {
+  auto const& l = impl::ColumnAccess::Columns(left);
+  auto const& r = impl::ColumnAccess::Columns(right);
+  impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> result;
+  auto const matched =
+      impl::MergeMatchRows(std::get<LeftKey>(l), std::get<RightKey>(r));
+  impl::GatherJoin<RightKey>(l, matched.probe, r, matched.build,
+                             impl::ColumnAccess::Columns(result));
+  return result;
+}
+
+/**
+ * @brief As-of join of @left and @right on the columns @LeftKey and
+ * @RightKey, which must have the same type and be sorted in ascending
+ * order: every row of @left is paired with the last row of @right whose key
+ * is not greater than its own.
+ *
+ * Both key columns are walked once, without a hash table. Rows of @left
+ * without such a row get default-constructed values in the columns of
+ * @right.
+ *
+ * @returns A %DataFrame with the columns of @left followed by those of
+ * @right but @RightKey, with one row per row of @left.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs>
+auto asofJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right)
+    -> impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> {
+  auto const& l = impl::ColumnAccess::Columns(left);
+  auto const& r = impl::ColumnAccess::Columns(right);
+  impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> result;
+  auto const matched =
+      impl::AsofMatchRows(std::get<LeftKey>(l), std::get<RightKey>(r),
+                          [](auto const&, auto const&) { return true; });
+  impl::GatherJoin<RightKey>(l, matched.probe, r, matched.build,
+                             impl::ColumnAccess::Columns(result));
+  return result;
+}
+
+/**
+ * @brief As-of join with a tolerance: like asofJoin(left, right), but rows
+ * of @right whose key is more than @tolerance below the key of the row of
+ * @left are not matched.
+ *
+ * @param tolerance Largest difference between the left and the right key.
+ */
+template <std::size_t LeftKey, std::size_t RightKey, typename... Ls,
+          typename... Rs, typename Tolerance>
+auto asofJoin(DataFrame<Ls...> const& left, DataFrame<Rs...> const& right,
+              Tolerance const& tolerance)
+    -> impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> {
+  auto const& l = impl::ColumnAccess::Columns(left);
+  auto const& r = impl::ColumnAccess::Columns(right);
+  impl::JoinResultType<DataFrame<Ls...>, DataFrame<Rs...>, RightKey> result;
+  auto const matched = impl::AsofMatchRows(
+      std::get<LeftKey>(l), std::get<RightKey>(r),
+      [&](auto const& key, auto const& match) {
+        return !(tolerance < key - match);
+      });
+  impl::GatherJoin<RightKey>(l, matched.probe, r, matched.build,
+                             impl::ColumnAccess::Columns(result));
+  return result;
+}
+}  // namespace df
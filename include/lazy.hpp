@@ -0,0 +1,331 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dataframe_fwd.hpp"
+#include "dataframe_impl.hpp"
+#include "expr.hpp"
+#include "reductions.hpp"
+#include "string_column.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Predicate of a pipeline without filters.
+ */
+struct AllRows {};
+
+/**
+ * @brief Number of rows processed at a time by a pipeline. A morsel of every
+ * column read stays in the L1 cache between the steps of the pipeline.
+ */
+inline constexpr std::size_t MorselRows = 1024;
+}  // namespace impl
+
+template <typename DF, typename Predicate, typename... Es>
+class Lazy;
+
+/**
+ * @brief Lazy query pipeline over a %DataFrame, as returned by
+ * DataFrame::lazy().
+ *
+ * Every step returns a new pipeline, whose type records the whole plan:
+ * each of its columns is a column expression over the source %DataFrame,
+ * and its rows are the source rows satisfying @Predicate. Hence
+ *  - consecutive transforms are fused into a single expression per column,
+ *  - filters are rewritten over the source columns, which pushes them ahead
+ *    of every projection and transform, and
+ *  - projections only drop expressions, without touching data.
+ *
+ * Nothing is computed until a terminal step, collect() or a reduction, which
+ * streams the source in morsels of MorselRows rows: the predicate is
+ * evaluated on a morsel to select its rows, then the columns are evaluated
+ * on the selected rows only, so no intermediate %DataFrame is built.
+ *
+ * The pipeline refers to the source %DataFrame, which must outlive it.
+ */
+template <typename... Ts, typename Predicate, typename... Es>
+class Lazy<DataFrame<Ts...>, Predicate, Es...> {
+ public:
+  /** Number of columns of the pipeline. */
+  static constexpr std::size_t NumCols = sizeof...(Es);
+
+  /** Type of the values of column @Col of the pipeline. */
+  template <std::size_t Col>
+  using ValueType =
+      expr::ResultType<std::tuple_element_t<Col, std::tuple<Es...>>, Ts...>;
+
+  /** Type of the %DataFrame returned by collect(). */
+  using ResultType =
+      DataFrame<typename impl::ColumnFor<expr::ResultType<Es, Ts...>>::type...>;
+
+  Lazy(DataFrame<Ts...> const& df, Predicate predicate,
+       std::tuple<Es...> columns)
+      : df_{&df}, predicate_{predicate}, columns_{columns} {}
+
+  /**
+   * @brief Keep only the rows on which the boolean expression @e, over the
+   * columns of the pipeline, holds.
+   */
+  template <expr::Expression E>
+  auto filter(E const& e) const {
+    auto condition = expr::Substitute(e, columns_);
+    if constexpr (std::is_same_v<Predicate, impl::AllRows>) {
+      return Lazy<DataFrame<Ts...>, decltype(condition), Es...>{
+          *df_, condition, columns_};
+    } else {
+      auto both = predicate_ && condition;
+      return Lazy<DataFrame<Ts...>, decltype(both), Es...>{*df_, both,
+                                                          columns_};
+    }
+  }
+
+  /**
+   * @brief Keep only the columns @Cols, in this order.
+   */
+  template <std::size_t... Cols>
+  auto project() const {
+    return Lazy<DataFrame<Ts...>, Predicate, ColumnType<Cols>...>{
+        *df_, predicate_, {std::get<Cols>(columns_)...}};
+  }
+
+  /**
+   * @brief Replace column @Col with the values of the expression @e over the
+   * columns of the pipeline, e.g. `transform<0>(col<0>() * 2)`.
+   */
+  template <std::size_t Col, expr::Expression E>
+  auto transform(E const& e) const {
+    static_assert(Col < NumCols, "Column out of range");
+    auto mapped = expr::Substitute(e, columns_);
+    return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      using Mapped = decltype(mapped);
+      return Lazy<DataFrame<Ts...>, Predicate,
+                  std::conditional_t<Is == Col, Mapped, ColumnType<Is>>...>{
+          *df_, predicate_,
+          {Pick<Is == Col>(mapped, std::get<Is>(columns_))...}};
+    }(std::index_sequence_for<Es...>{});
+  }
+
+  /**
+   * @brief Add a column with the values of the expression @e over the
+   * columns of the pipeline.
+   */
+  template <expr::Expression E>
+  auto with(E const& e) const {
+    auto added = expr::Substitute(e, columns_);
+    return Lazy<DataFrame<Ts...>, Predicate, Es..., decltype(added)>{
+        *df_, predicate_, std::tuple_cat(columns_, std::tuple{added})};
+  }
+
+  /**
+   * @brief Run the pipeline and return its rows, in a %DataFrame growing
+   * with the policy of the source.
+   */
+  auto collect() const -> ResultType {
+    ResultType result;
+    result.setGrowthPolicy(df_->growthPolicy());
+    auto& out = impl::ColumnAccess::Columns(result);
+    if constexpr (std::is_same_v<Predicate, impl::AllRows>) {
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        (std::get<Is>(out).reserve(sourceSize()), ...);
+      }(std::index_sequence_for<Es...>{});
+    }
+    auto const fs = bindColumns();
+    forEachMorsel([&](std::span<std::size_t const> rows) {
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+        (Collect(std::get<Is>(fs), rows, std::get<Is>(out)), ...);
+      }(std::index_sequence_for<Es...>{});
+    });
+    return result;
+  }
+
+  /**
+   * @brief Run the pipeline and return its number of rows. Only the
+   * predicate is evaluated.
+   */
+  auto count() const -> std::size_t {
+    std::size_t count = 0;
+    forEachMorsel(
+        [&](std::span<std::size_t const> rows) { count += rows.size(); });
+    return count;
+  }
+
+  /**
+   * @brief Run the pipeline and return the sum of column @Col, compensated
+   * like DataFrame::sum().
+   */
+  template <std::size_t Col>
+  auto sum() const -> impl::SumType<ValueType<Col>> {
+    using R = ValueType<Col>;
+    if constexpr (std::is_floating_point_v<R>) {
+      impl::KahanSum<R> acc;
+      forEachBlock<Col>([&](std::span<R const> b) { acc.add(impl::Sum(b)); });
+      return acc.sum;
+    } else {
+      impl::SumType<R> sum = 0;
+      forEachBlock<Col>([&](std::span<R const> b) { sum += impl::Sum(b); });
+      return sum;
+    }
+  }
+
+  /**
+   * @brief Run the pipeline and return the smallest value of column @Col.
+   * The pipeline must not be empty.
+   */
+  template <std::size_t Col>
+  auto min() const -> ValueType<Col> {
+    return minMax<Col, false>();
+  }
+
+  /**
+   * @brief Run the pipeline and return the largest value of column @Col.
+   * The pipeline must not be empty.
+   */
+  template <std::size_t Col>
+  auto max() const -> ValueType<Col> {
+    return minMax<Col, true>();
+  }
+
+  /**
+   * @brief Run the pipeline and return the arithmetic mean of column @Col,
+   * or NaN if the pipeline is empty.
+   */
+  template <std::size_t Col>
+  auto mean() const -> double {
+    using R = ValueType<Col>;
+    impl::SumType<R> sum = 0;
+    std::size_t count = 0;
+    forEachBlock<Col>([&](std::span<R const> b) {
+      sum += impl::Sum(b);
+      count += b.size();
+    });
+    return static_cast<double>(sum) / count;
+  }
+
+ private:
+  template <std::size_t Col>
+  using ColumnType = std::tuple_element_t<Col, std::tuple<Es...>>;
+
+  template <bool First, typename A, typename B>
+  static auto Pick(A const& a, B const& b) {
+    if constexpr (First) {
+      return a;
+    } else {
+      return b;
+    }
+  }
+
+  template <typename F, typename T>
+  static auto Collect(F const& f, std::span<std::size_t const> rows,
+                      impl::Column<T>& out) -> void {
+    for (std::size_t row : rows) {
+      out.push_back(f(row));
+    }
+  }
+
+  auto source() const -> auto const& {
+    return impl::ColumnAccess::Columns(*df_);
+  }
+
+  auto sourceSize() const -> std::size_t {
+    return std::get<0>(source()).size();
+  }
+
+  auto bindColumns() const {
+    return std::apply(
+        [&](auto const&... es) { return std::tuple{es.bind(source())...}; },
+        columns_);
+  }
+
+  /**
+   * @brief Call @f with the selected rows of every morsel of the source.
+   * Rows are selected without branching on the predicate.
+   */
+  template <typename F>
+  auto forEachMorsel(F&& f) const -> void {
+    std::size_t const n = sourceSize();
+    std::size_t rows[impl::MorselRows];
+    if constexpr (std::is_same_v<Predicate, impl::AllRows>) {
+      for (std::size_t b = 0; b < n; b += impl::MorselRows) {
+        std::size_t const size = std::min(impl::MorselRows, n - b);
+        for (std::size_t i = 0; i < size; ++i) {
+          rows[i] = b + i;
+        }
+        f(std::span<std::size_t const>{rows, size});
+      }
+    } else {
+      auto const predicate = predicate_.bind(source());
+      for (std::size_t b = 0; b < n; b += impl::MorselRows) {
+        std::size_t const e = std::min(b + impl::MorselRows, n);
+        std::size_t size = 0;
+        for (std::size_t i = b; i < e; ++i) {
+          rows[size] = i;
+          size += static_cast<bool>(predicate(i));
+        }
+        if (size > 0) {
+          f(std::span<std::size_t const>{rows, size});
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief Call @reduce with the values of column @Col on the selected rows
+   * of every morsel.
+   */
+  template <std::size_t Col, typename Reduce>
+  auto forEachBlock(Reduce&& reduce) const -> void {
+    using R = ValueType<Col>;
+    auto const f = std::get<Col>(columns_).bind(source());
+    R block[impl::MorselRows];
+    forEachMorsel([&](std::span<std::size_t const> rows) {
+      for (std::size_t i = 0; i < rows.size(); ++i) {
+        block[i] = f(rows[i]);
+      }
+      reduce(std::span<R const>{block, rows.size()});
+    });
+  }
+
+  template <std::size_t Col, bool Max>
+  auto minMax() const -> ValueType<Col> {
+    using R = ValueType<Col>;
+    R result{};
+    bool first = true;
+    forEachBlock<Col>([&](std::span<R const> b) {
+      R const m = impl::MinMax<Max>(b);
+      result = first ? m : Max ? std::max(result, m) : std::min(result, m);
+      first = false;
+    });
+    assert(!first);
+    return result;
+  }
+
+  DataFrame<Ts...> const* df_;
+  [[no_unique_address]] Predicate predicate_;
+  std::tuple<Es...> columns_;
+};
+}  // namespace df
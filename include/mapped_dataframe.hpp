@@ -0,0 +1,272 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include "categorical.hpp"
+#include "columnar.hpp"
+#include "dataframe_fwd.hpp"
+#include "iterator.hpp"
+#include "mapped_file.hpp"
+#include "string_column.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Read-only view over a fixed-size column of a mapped columnar file.
+ */
+template <typename T>
+class MappedColumn {
+ public:
+  using Reference = T const&;
+
+  MappedColumn() noexcept = default;
+
+  MappedColumn(char const* base, ColumnarColumnHeader const& header) noexcept
+      : data_{reinterpret_cast<T const*>(base + header.dataOffset)} {}
+
+  auto operator[](std::size_t row) const noexcept -> Reference {
+    return data_[row];
+  }
+
+  auto data() const noexcept -> T const* { return data_; }
+
+ private:
+  T const* data_ = nullptr;
+};
+
+/**
+ * @brief Read-only view over a string column of a mapped columnar file,
+ * whatever the allocator of the strings saved, e.g. `std::pmr::string`.
+ */
+template <typename Alloc>
+class MappedColumn<std::basic_string<char, std::char_traits<char>, Alloc>> {
+ public:
+  using Reference = std::string_view;
+
+  MappedColumn() noexcept = default;
+
+  MappedColumn(char const* base, ColumnarColumnHeader const& header) noexcept
+      : offsets_{reinterpret_cast<std::uint64_t const*>(base +
+                                                        header.offsetsOffset)},
+        bytes_{base + header.dataOffset} {}
+
+  auto operator[](std::size_t row) const noexcept -> Reference {
+    return {bytes_ + offsets_[row], offsets_[row + 1] - offsets_[row]};
+  }
+
+ private:
+  std::uint64_t const* offsets_ = nullptr;
+  char const* bytes_ = nullptr;
+};
+
+/**
+ * @brief Read-only view over a df::str column of a mapped columnar file,
+ * which has the layout of string columns.
+ */
+template <>
+class MappedColumn<str> : public MappedColumn<std::string> {
+ public:
+  using MappedColumn<std::string>::MappedColumn;
+};
+
+/**
+ * @brief Read-only view over a categorical column of strings of a mapped
+ * columnar file, which stores the values decoded, with the layout of string
+ * columns.
+ */
+template <typename V, typename Code>
+class MappedColumn<Categorical<V, Code>> : public MappedColumn<std::string> {
+ public:
+  static_assert(IsString<V>, "Mapped categorical columns must hold strings");
+
+  using MappedColumn<std::string>::MappedColumn;
+};
+
+/**
+ * @brief Check that @header describes a column of @T whose blocks lie
+ * within the file of @fileSize bytes mapped at @base, holding @numRows rows.
+ * Sizes are checked without overflowing, and the offsets of string columns
+ * must start at 0, never decrease and end within their data block.
+ */
+template <typename T>
+auto IsValidColumn(ColumnarColumnHeader const& header, std::uint64_t numRows,
+                   char const* base, std::uint64_t fileSize) noexcept -> bool {
+  auto fits = [&](std::uint64_t offset, std::uint64_t size) {
+    return offset % ColumnarAlignment == 0 && offset <= fileSize &&
+           size <= fileSize - offset;
+  };
+  if (header.type != ColumnarTypeOf<T>() ||
+      header.elementSize != ColumnarElementSize<T>()) {
+    return false;
+  }
+  if constexpr (IsString<T>) {
+    if (numRows >= fileSize / sizeof(std::uint64_t) ||
+        !fits(header.offsetsOffset, (numRows + 1) * sizeof(std::uint64_t)) ||
+        !fits(header.dataOffset, header.dataSize)) {
+      return false;
+    }
+    auto const* offsets =
+        reinterpret_cast<std::uint64_t const*>(base + header.offsetsOffset);
+    if (offsets[0] != 0 || offsets[numRows] > header.dataSize) {
+      return false;
+    }
+    for (std::uint64_t row = 0; row < numRows; ++row) {
+      if (offsets[row + 1] < offsets[row]) {
+        return false;
+      }
+    }
+    return true;
+  } else {
+    (void)base;
+    return numRows <= fileSize / sizeof(T) &&
+           header.dataSize == numRows * sizeof(T) &&
+           fits(header.dataOffset, header.dataSize);
+  }
+}
+}  // namespace impl
+
+/**
+ * @brief Read-only %DataFrame backed by a file written by DataFrame::save().
+ *
+ * The file is memory-mapped and rows are read in place, so opening it costs
+ * no parsing nor copying, and processes mapping the same file share its
+ * pages. String values are returned as `std::string_view`.
+ */
+template <typename... Ts>
+class MappedDataFrame {
+ public:
+  static constexpr int NumCols = sizeof...(Ts);
+  using RowType = std::tuple<Ts...>;
+  using ConstRefType =
+      std::tuple<typename impl::MappedColumn<Ts>::Reference...>;
+
+  using ConstRowIterator = ConstRowIteratorImpl<MappedDataFrame>;
+
+  template <std::size_t Col>
+  using ValueType = std::tuple_element_t<Col, RowType>;
+
+  /**
+   * @brief Map the columnar file at @path.
+   *
+   * @param path Path of a file written by `DataFrame<Ts...>::save()`.
+   * @throws std::system_error if the file cannot be mapped.
+   * @throws std::runtime_error if the file is not a columnar file with
+   * columns of types @Ts.
+   */
+  explicit MappedDataFrame(std::string const& path)
+      : file_{path, MADV_NORMAL} {
+    impl::ColumnarFileHeader fileHeader;
+    std::size_t const headersSize =
+        sizeof(fileHeader) + NumCols * sizeof(impl::ColumnarColumnHeader);
+    if (file_.size() < headersSize) {
+      throw std::runtime_error(path + " is not a columnar file");
+    }
+    std::memcpy(&fileHeader, file_.data(), sizeof(fileHeader));
+    if (std::memcmp(fileHeader.magic, impl::ColumnarMagic,
+                    sizeof(impl::ColumnarMagic)) != 0 ||
+        fileHeader.version != impl::ColumnarVersion ||
+        fileHeader.byteOrderMark != impl::ColumnarByteOrderMark) {
+      throw std::runtime_error(path + " is not a columnar file");
+    }
+    if (fileHeader.numCols != NumCols) {
+      throw std::runtime_error(path + " does not have " +
+                               std::to_string(NumCols) + " columns");
+    }
+    numRows_ = fileHeader.numRows;
+    mapColumns(path, std::make_index_sequence<NumCols>{});
+  }
+
+  /**
+   * @brief Returns a read-only iterator that points to the first row.
+   */
+  auto begin() const noexcept -> ConstRowIterator { return {this, 0}; }
+
+  /**
+   * @brief Returns a read-only iterator that points to the first row.
+   */
+  auto cbegin() const noexcept -> ConstRowIterator { return {this, 0}; }
+
+  /**
+   * @brief Returns a read-only iterator that points one past the last row.
+   */
+  auto end() const noexcept -> ConstRowIterator { return {this, size()}; }
+
+  /**
+   * @brief Returns a read-only iterator that points one past the last row.
+   */
+  auto cend() const noexcept -> ConstRowIterator { return {this, size()}; }
+
+  /**
+   * @brief Returns the number of rows stored in the file.
+   */
+  auto size() const noexcept -> std::size_t { return numRows_; }
+
+  /**
+   * @brief Get the elements of @row. Strings are returned as views into the
+   * mapped file.
+   */
+  auto get(std::size_t row) const noexcept -> ConstRefType {
+    return std::apply(
+        [row](auto const&... columns) -> ConstRefType {
+          return {columns[row]...};
+        },
+        columns_);
+  }
+
+  /**
+   * @brief Get a read-only view over the contiguous data of column @Col.
+   */
+  template <std::size_t Col>
+  auto column() const noexcept -> std::span<ValueType<Col> const> {
+    static_assert(!impl::IsString<ValueType<Col>>,
+                  "String columns are not stored as contiguous values");
+    return {std::get<Col>(columns_).data(), numRows_};
+  }
+
+ private:
+  template <std::size_t... Is>
+  auto mapColumns(std::string const& path, std::index_sequence<Is...>)
+      -> void {
+    impl::ColumnarColumnHeader headers[NumCols];
+    std::memcpy(headers, file_.data() + sizeof(impl::ColumnarFileHeader),
+                sizeof(headers));
+    bool const valid = (impl::IsValidColumn<Ts>(headers[Is], numRows_,
+                                                file_.data(), file_.size()) &&
+                        ...);
+    if (!valid) {
+      throw std::runtime_error(path +
+                               " does not match the requested column types");
+    }
+    ((std::get<Is>(columns_) =
+          impl::MappedColumn<Ts>{file_.data(), headers[Is]}),
+     ...);
+  }
+
+  impl::MappedFile file_;
+  std::uint64_t numRows_ = 0;
+  std::tuple<impl::MappedColumn<Ts>...> columns_;
+};
+}  // namespace df
@@ -0,0 +1,107 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace df {
+namespace impl {
+/**
+ * @brief Read-only memory mapping of a whole file. The mapping is released
+ * when the object is destroyed.
+ */
+class MappedFile {
+ public:
+  /**
+   * @brief Map the file at @path.
+   *
+   * @param path Path of the file to map.
+   * @param advice Access pattern hint passed to madvise().
+   * @throws std::system_error if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(std::string const& path, int advice = MADV_SEQUENTIAL) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "cannot open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+      int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(),
+                              "cannot stat " + path);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+      void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(),
+                                "cannot map " + path);
+      }
+      ::madvise(addr, size_, advice);
+      data_ = static_cast<char const*>(addr);
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile() noexcept {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  MappedFile(MappedFile const&) = delete;
+  auto operator=(MappedFile const&) -> MappedFile& = delete;
+
+  MappedFile(MappedFile&& other) noexcept
+      : data_{std::exchange(other.data_, nullptr)},
+        size_{std::exchange(other.size_, 0)} {}
+
+  auto operator=(MappedFile&& other) noexcept -> MappedFile& {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    return *this;
+  }
+
+  /**
+   * @brief Returns a pointer to the first byte of the file.
+   */
+  auto data() const noexcept -> char const* { return data_; }
+
+  /**
+   * @brief Returns the size of the file in bytes.
+   */
+  auto size() const noexcept -> std::size_t { return size_; }
+
+ private:
+  char const* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+}  // namespace impl
+}  // namespace df
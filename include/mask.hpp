@@ -0,0 +1,439 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+#include "simd.hpp"
+
+namespace df {
+/**
+ * @brief Set of selected rows of a %DataFrame, stored as a packed bitmask
+ * with one bit per row.
+ *
+ * Masks produced by DataFrame::filter() on different columns of the same
+ * %DataFrame can be combined with the bitwise operators.
+ */
+class Mask {
+ public:
+  static constexpr std::size_t WordBits = 64;
+
+  Mask() noexcept = default;
+
+  /**
+   * @brief Create a mask of @size rows, all selected if @value is true.
+   */
+  explicit Mask(std::size_t size, bool value = false)
+      : words_((size + WordBits - 1) / WordBits,
+               value ? ~std::uint64_t{0} : std::uint64_t{0}),
+        size_{size} {
+    clearPadding();
+  }
+
+  /**
+   * @brief Returns the number of rows covered by the mask.
+   */
+  auto size() const noexcept -> std::size_t { return size_; }
+
+  /**
+   * @brief Returns the number of selected rows.
+   */
+  auto count() const noexcept -> std::size_t {
+    std::size_t count = 0;
+    for (auto word : words_) {
+      count += std::popcount(word);
+    }
+    return count;
+  }
+
+  /**
+   * @brief Returns whether row @i is selected.
+   */
+  auto test(std::size_t i) const noexcept -> bool {
+    assert(i < size_);
+    return (words_[i / WordBits] >> (i % WordBits)) & 1;
+  }
+
+  /**
+   * @brief Select or deselect row @i.
+   */
+  auto set(std::size_t i, bool value = true) noexcept -> void {
+    assert(i < size_);
+    std::uint64_t const bit = std::uint64_t{1} << (i % WordBits);
+    words_[i / WordBits] = value ? words_[i / WordBits] | bit
+                                 : words_[i / WordBits] & ~bit;
+  }
+
+  /**
+   * @brief Returns the words of the mask. Row i is bit i % 64 of word i / 64;
+   * the bits past the last row are zero.
+   */
+  auto words() const noexcept -> std::span<std::uint64_t const> {
+    return words_;
+  }
+
+  /**
+   * @brief Returns the words of the mask, for writing. Callers must keep the
+   * bits past the last row at zero.
+   */
+  auto words() noexcept -> std::span<std::uint64_t> { return words_; }
+
+  /**
+   * @brief Returns the selection vector of the mask: the indices of the
+   * selected rows, in increasing order.
+   */
+  auto selection() const -> std::vector<std::size_t> {
+    std::vector<std::size_t> rows;
+    rows.reserve(count());
+    forEachSelected([&](std::size_t i) { rows.push_back(i); });
+    return rows;
+  }
+
+  /**
+   * @brief Call @f with the index of every selected row, in increasing
+   * order.
+   */
+  template <typename F>
+  auto forEachSelected(F&& f) const -> void {
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      for (std::uint64_t word = words_[w]; word != 0; word &= word - 1) {
+        f(w * WordBits + std::countr_zero(word));
+      }
+    }
+  }
+
+  auto operator&=(Mask const& other) noexcept -> Mask& {
+    assert(size_ == other.size_);
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      words_[w] &= other.words_[w];
+    }
+    return *this;
+  }
+
+  auto operator|=(Mask const& other) noexcept -> Mask& {
+    assert(size_ == other.size_);
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      words_[w] |= other.words_[w];
+    }
+    return *this;
+  }
+
+  auto operator^=(Mask const& other) noexcept -> Mask& {
+    assert(size_ == other.size_);
+    for (std::size_t w = 0; w < words_.size(); ++w) {
+      words_[w] ^= other.words_[w];
+    }
+    return *this;
+  }
+
+  friend auto operator&(Mask lhs, Mask const& rhs) noexcept -> Mask {
+    return lhs &= rhs;
+  }
+
+  friend auto operator|(Mask lhs, Mask const& rhs) noexcept -> Mask {
+    return lhs |= rhs;
+  }
+
+  friend auto operator^(Mask lhs, Mask const& rhs) noexcept -> Mask {
+    return lhs ^= rhs;
+  }
+
+  friend auto operator~(Mask mask) noexcept -> Mask {
+    for (auto& word : mask.words_) {
+      word = ~word;
+    }
+    mask.clearPadding();
+    return mask;
+  }
+
+  friend auto operator==(Mask const&, Mask const&) -> bool = default;
+
+ private:
+  auto clearPadding() noexcept -> void {
+    if (size_ % WordBits != 0) {
+      words_.back() &= (std::uint64_t{1} << (size_ % WordBits)) - 1;
+    }
+  }
+
+  std::vector<std::uint64_t> words_;
+  std::size_t size_ = 0;
+};
+
+/**
+ * @brief Predicate comparing values against a constant. Filters on columns
+ * with vector support use SIMD compares for these instead of calling them on
+ * every value.
+ */
+template <impl::CmpOp Op, typename V>
+struct Comparison {
+  static constexpr impl::CmpOp Operator = Op;
+  V value;
+
+  template <typename T>
+  constexpr auto operator()(T const& x) const -> bool {
+    if constexpr (Op == impl::CmpOp::Lt) {
+      return x < value;
+    } else if constexpr (Op == impl::CmpOp::Le) {
+      return x <= value;
+    } else if constexpr (Op == impl::CmpOp::Gt) {
+      return x > value;
+    } else if constexpr (Op == impl::CmpOp::Ge) {
+      return x >= value;
+    } else if constexpr (Op == impl::CmpOp::Eq) {
+      return x == value;
+    } else {
+      return x != value;
+    }
+  }
+};
+
+template <typename V>
+constexpr auto lt(V value) -> Comparison<impl::CmpOp::Lt, V> {
+  return {std::move(value)};
+}
+
+template <typename V>
+constexpr auto le(V value) -> Comparison<impl::CmpOp::Le, V> {
+  return {std::move(value)};
+}
+
+template <typename V>
+constexpr auto gt(V value) -> Comparison<impl::CmpOp::Gt, V> {
+  return {std::move(value)};
+}
+
+template <typename V>
+constexpr auto ge(V value) -> Comparison<impl::CmpOp::Ge, V> {
+  return {std::move(value)};
+}
+
+template <typename V>
+constexpr auto eq(V value) -> Comparison<impl::CmpOp::Eq, V> {
+  return {std::move(value)};
+}
+
+template <typename V>
+constexpr auto ne(V value) -> Comparison<impl::CmpOp::Ne, V> {
+  return {std::move(value)};
+}
+
+namespace impl {
+template <typename Pred>
+struct IsComparison : std::false_type {};
+
+template <CmpOp Op, typename V>
+struct IsComparison<Comparison<Op, V>> : std::true_type {};
+
+/**
+ * @brief Whether @Pred compares values against a constant of their own type
+ * @T, which SIMD compares can evaluate without changing the result. Other
+ * constants are compared in the common type by the scalar loop.
+ */
+template <typename Pred, typename T>
+inline constexpr bool IsComparisonOf = false;
+
+template <CmpOp Op, typename V, typename T>
+inline constexpr bool IsComparisonOf<Comparison<Op, V>, T> =
+    std::is_same_v<V, T>;
+
+/**
+ * @brief Set the bits of @words, which must be zero, of the values of
+ * @values satisfying @pred: bit i % 64 of word i / 64 for value i. @values
+ * is a column or a span of values.
+ *
+ * Results are packed 64 at a time without branches. Comparisons against a
+ * constant of the type of the values, on types with vector support, are
+ * evaluated with SIMD compares.
+ */
+template <typename Values, typename Pred>
+auto FilterInto(Values const& values, Pred const& pred,
+                std::span<std::uint64_t> words) -> void {
+  using T = typename Values::value_type;
+  std::size_t const numFull = values.size() / Mask::WordBits;
+  std::size_t w = 0;
+  if constexpr (IsComparisonOf<Pred, T> && SimdTraits<T>::Enabled) {
+    using S = SimdTraits<T>;
+    typename S::Reg const value = S::set1(pred.value);
+    for (; w < numFull; ++w) {
+      T const* p = values.data() + w * Mask::WordBits;
+      std::uint64_t word = 0;
+      for (std::size_t k = 0; k < Mask::WordBits; k += S::Width) {
+        unsigned const lanes =
+            S::template compare<Pred::Operator>(S::load(p + k), value);
+        word |= static_cast<std::uint64_t>(lanes) << k;
+      }
+      words[w] = word;
+    }
+  }
+  for (; w < numFull; ++w) {
+    std::size_t const base = w * Mask::WordBits;
+    std::uint64_t word = 0;
+    for (std::size_t k = 0; k < Mask::WordBits; ++k) {
+      bool const selected = pred(values[base + k]);
+      word |= static_cast<std::uint64_t>(selected) << k;
+    }
+    words[w] = word;
+  }
+  for (std::size_t i = numFull * Mask::WordBits; i < values.size(); ++i) {
+    bool const selected = pred(values[i]);
+    words[w] |= static_cast<std::uint64_t>(selected) << (i % Mask::WordBits);
+  }
+}
+
+/**
+ * @brief Returns the mask of the values of @values satisfying @pred.
+ */
+template <typename T, typename Pred>
+auto Filter(Column<T> const& values, Pred const& pred) -> Mask {
+  Mask mask{values.size()};
+  FilterInto(values, pred, mask.words());
+  return mask;
+}
+
+/**
+ * @brief Returns the mask of the values of the nullable column @values
+ * satisfying @pred, which never selects nulls. @pred is evaluated on the
+ * dense values, then the mask is intersected with the validity bitmap a
+ * word at a time.
+ */
+template <typename T, typename Pred>
+auto Filter(Column<Nullable<T>> const& values, Pred const& pred) -> Mask {
+  Mask mask = Filter(values.values(), pred);
+  auto const validity = values.validity();
+  if (!validity.empty()) {
+    auto words = mask.words();
+    for (std::size_t w = 0; w < words.size(); ++w) {
+      words[w] &= validity[w];
+    }
+  }
+  return mask;
+}
+
+/**
+ * @brief Returns the mask of the values of the categorical column @values
+ * satisfying @pred, which is evaluated once per value of the dictionary.
+ */
+template <typename V, typename Code, typename Pred>
+auto Filter(Column<Categorical<V, Code>> const& values, Pred const& pred)
+    -> Mask {
+  auto const& dictionary = values.dictionary();
+  std::vector<char> selected(dictionary.size());
+  for (std::size_t c = 0; c < selected.size(); ++c) {
+    selected[c] = static_cast<bool>(pred(dictionary[c]));
+  }
+  return Filter(values.codes(),
+                [&](Code code) -> bool { return selected[code]; });
+}
+
+/**
+ * @brief Append the values of @from selected by @mask to @to. Categorical
+ * columns append the codes of @from, translated into the dictionary of @to.
+ * Encoded columns are decoded a block at a time.
+ */
+template <typename T>
+auto AppendMasked(Column<T> const& from, Mask const& mask,
+                  Column<T>& to) -> void {
+  assert(from.size() == mask.size());
+  if constexpr (IsCategorical<T>) {
+    auto const codes = to.mapDictionary(from);
+    auto& out = to.codes();
+    out.reserve(out.size() + mask.count());
+    mask.forEachSelected(
+        [&](std::size_t i) { out.push_back(codes[from.code(i)]); });
+  } else if constexpr (IsEncoded<T>) {
+    auto words = mask.words();
+    from.forEachBlock([&](std::size_t first, auto values) {
+      // Blocks start on a word of the mask.
+      for (std::size_t k = 0; k < values.size(); k += Mask::WordBits) {
+        std::uint64_t word = words[(first + k) / Mask::WordBits];
+        for (; word != 0; word &= word - 1) {
+          to.push_back(values[k + std::countr_zero(word)]);
+        }
+      }
+    });
+  } else {
+    auto words = mask.words();
+    for (std::size_t w = 0; w < words.size(); ++w) {
+      std::size_t const base = w * Mask::WordBits;
+      if (words[w] == ~std::uint64_t{0}) {
+        to.insert(to.end(), from.begin() + base,
+                  from.begin() + base + Mask::WordBits);
+        continue;
+      }
+      for (std::uint64_t word = words[w]; word != 0; word &= word - 1) {
+        to.push_back(from[base + std::countr_zero(word)]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Keep only the values of @column selected by @mask, preserving their
+ * order, in a single pass. Categorical columns compact their codes, keeping
+ * their dictionary. Other columns whose values cannot be assigned in place,
+ * such as df::str columns, are rebuilt instead.
+ */
+template <typename T>
+auto CompactMasked(Column<T>& column, Mask const& mask) -> void {
+  assert(column.size() == mask.size());
+  if constexpr (IsCategorical<T>) {
+    CompactMasked(column.codes(), mask);
+  } else if constexpr (IsAssignable<T>) {
+    auto words = mask.words();
+    std::size_t out = 0;
+    for (std::size_t w = 0; w < words.size(); ++w) {
+      std::size_t const base = w * Mask::WordBits;
+      for (std::uint64_t word = words[w]; word != 0; word &= word - 1) {
+        std::size_t const i = base + std::countr_zero(word);
+        if (i != out) {
+          column[out] = std::move(column[i]);
+        }
+        ++out;
+      }
+    }
+    column.erase(column.begin() + out, column.end());
+  } else {
+    Column<T> compacted{column.get_allocator()};
+    compacted.reserve(mask.count());
+    AppendMasked(column, mask, compacted);
+    column.swap(compacted);
+  }
+}
+
+template <typename... Ts, std::size_t... Is>
+auto AppendMaskedColumns(std::tuple<Column<Ts>...> const& from,
+                         Mask const& mask, std::tuple<Column<Ts>...>& to,
+                         std::index_sequence<Is...>) -> void {
+  (AppendMasked(std::get<Is>(from), mask, std::get<Is>(to)), ...);
+}
+
+template <typename... Ts, std::size_t... Is>
+auto CompactMaskedColumns(std::tuple<Column<Ts>...>& columns,
+                          Mask const& mask, std::index_sequence<Is...>)
+    -> void {
+  (CompactMasked(std::get<Is>(columns), mask), ...);
+}
+}  // namespace impl
+}  // namespace df
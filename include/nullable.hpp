@@ -0,0 +1,369 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+
+namespace df {
+/**
+ * @brief Column type holding values of the arithmetic type @T or nulls,
+ * e.g. `DataFrame<int, Nullable<double>>`.
+ *
+ * The values are kept dense, with T{} in place of nulls, so that they can be
+ * reduced with vector code, along with a packed validity bitmap with one bit
+ * per row, which is only allocated once the column holds a null. Values are
+ * appended and read as `std::optional<T>`s: append df::null for a missing
+ * value. Reductions and filters skip nulls.
+ */
+template <typename T>
+struct Nullable {
+  static_assert(std::is_arithmetic_v<T>,
+                "Nullable columns hold arithmetic values");
+};
+
+/**
+ * @brief Marker of a missing value, appended to nullable columns.
+ */
+inline constexpr std::nullopt_t null = std::nullopt;
+
+namespace impl {
+/**
+ * @brief Storage of a column of df::Nullable: the values, with T{} in place
+ * of nulls, the number of nulls and the validity bitmap, in which bit i % 64
+ * of word i / 64 is set if row i is not null.
+ *
+ * The bitmap is empty while the column holds no null; its bits past the last
+ * row are zero. Values can only be appended at the end.
+ */
+template <typename T>
+class Column<Nullable<T>> {
+ public:
+  using value_type = std::optional<T>;
+  using reference = std::optional<T>;
+  using const_reference = std::optional<T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  using const_iterator = ColumnIterator<Column>;
+  using iterator = const_iterator;
+
+  static constexpr std::size_t WordBits = 64;
+
+  Column() noexcept = default;
+
+  explicit Column(allocator_type alloc) noexcept
+      : values_{alloc}, validity_{alloc} {}
+
+  Column(Column const& other) = default;
+
+  Column(Column const& other, allocator_type alloc)
+      : values_{other.values_, alloc},
+        validity_{other.validity_, alloc},
+        numNulls_{other.numNulls_} {}
+
+  Column(Column&& other) noexcept
+      : values_{std::move(other.values_)},
+        validity_{std::move(other.validity_)},
+        numNulls_{std::exchange(other.numNulls_, 0)} {}
+
+  Column(Column&& other, allocator_type alloc)
+      : values_{std::move(other.values_), alloc},
+        validity_{std::move(other.validity_), alloc},
+        numNulls_{std::exchange(other.numNulls_, 0)} {}
+
+  auto operator=(Column const& other) -> Column& = default;
+
+  auto operator=(Column&& other) noexcept -> Column& {
+    Column{std::move(other)}.swap(*this);
+    return *this;
+  }
+
+  auto size() const noexcept -> std::size_t { return values_.size(); }
+
+  auto empty() const noexcept -> bool { return values_.empty(); }
+
+  auto capacity() const noexcept -> std::size_t { return values_.capacity(); }
+
+  /**
+   * @brief Make room for @numValues values. The bitmap is reserved with them
+   * once the column holds a null.
+   */
+  auto reserve(std::size_t numValues) -> void {
+    values_.reserve(numValues);
+    if (!validity_.empty()) {
+      validity_.reserve(NumWords(numValues));
+    }
+  }
+
+  auto clear() noexcept -> void {
+    values_.clear();
+    validity_.clear();
+    numNulls_ = 0;
+  }
+
+  auto get_allocator() const noexcept -> allocator_type {
+    return values_.get_allocator();
+  }
+
+  auto operator[](std::size_t i) const noexcept -> value_type {
+    return isNull(i) ? value_type{} : value_type{values_[i]};
+  }
+
+  auto begin() const noexcept -> const_iterator { return {this, 0}; }
+
+  auto end() const noexcept -> const_iterator { return {this, size()}; }
+
+  /**
+   * @brief Returns the values of the column, with T{} in place of nulls.
+   */
+  auto values() const noexcept -> Column<T> const& { return values_; }
+
+  /**
+   * @brief Returns the validity bitmap, empty if the column holds no null.
+   */
+  auto validity() const noexcept -> std::span<std::uint64_t const> {
+    return validity_;
+  }
+
+  /**
+   * @brief Returns the number of nulls.
+   */
+  auto nullCount() const noexcept -> std::size_t { return numNulls_; }
+
+  /**
+   * @brief Returns whether row @i is null.
+   */
+  auto isNull(std::size_t i) const noexcept -> bool {
+    return !validity_.empty() &&
+           !((validity_[i / WordBits] >> (i % WordBits)) & 1);
+  }
+
+  auto push_back(value_type const& value) -> void {
+    if (value) {
+      if (!validity_.empty()) {
+        appendBit(true);
+      }
+      values_.push_back(*value);
+    } else {
+      if (validity_.empty()) {
+        allocateValidity();
+      }
+      appendBit(false);
+      values_.push_back(T{});
+      ++numNulls_;
+    }
+  }
+
+  /**
+   * @brief Append the optional value constructed from @args.
+   */
+  template <typename... Args>
+  auto emplace_back(Args&&... args) -> value_type {
+    push_back(value_type(std::forward<Args>(args)...));
+    return (*this)[size() - 1];
+  }
+
+  /**
+   * @brief Append the values of [@first, @last), which must not belong to
+   * this column. @pos must be end().
+   *
+   * Values of another nullable column, possibly through move iterators, are
+   * appended with a single copy of the values and of the bitmap a word at a
+   * time.
+   */
+  template <std::input_iterator It>
+  auto insert(const_iterator pos, It first, It last) -> const_iterator {
+    assert(pos == end());
+    (void)pos;
+    std::size_t const row = size();
+    if constexpr (std::is_same_v<It, std::move_iterator<const_iterator>>) {
+      insert(pos, first.base(), last.base());
+    } else if constexpr (std::is_same_v<It, const_iterator>) {
+      appendRows(first.column(), first.row(), last.row());
+    } else {
+      for (; first != last; ++first) {
+        push_back(*first);
+      }
+    }
+    return {this, row};
+  }
+
+  auto swap(Column& other) noexcept -> void {
+    values_.swap(other.values_);
+    validity_.swap(other.validity_);
+    std::swap(numNulls_, other.numNulls_);
+  }
+
+ private:
+  static constexpr auto NumWords(std::size_t numBits) noexcept
+      -> std::size_t {
+    return (numBits + WordBits - 1) / WordBits;
+  }
+
+  static constexpr auto LowBits(std::size_t count) noexcept
+      -> std::uint64_t {
+    return count == WordBits ? ~std::uint64_t{0}
+                             : (std::uint64_t{1} << count) - 1;
+  }
+
+  /**
+   * @brief Returns the @count <= 64 bits of @words starting at bit @pos.
+   */
+  static auto ReadBits(std::span<std::uint64_t const> words, std::size_t pos,
+                       std::size_t count) noexcept -> std::uint64_t {
+    std::size_t const w = pos / WordBits;
+    std::size_t const shift = pos % WordBits;
+    std::uint64_t bits = words[w] >> shift;
+    if (shift != 0 && shift + count > WordBits) {
+      bits |= words[w + 1] << (WordBits - shift);
+    }
+    return bits & LowBits(count);
+  }
+
+  /**
+   * @brief Set the bitmap of the rows before the first null, all valid.
+   */
+  auto allocateValidity() -> void {
+    validity_.reserve(NumWords(values_.capacity()));
+    validity_.assign(NumWords(size()), ~std::uint64_t{0});
+    if (size() % WordBits != 0) {
+      validity_.back() = LowBits(size() % WordBits);
+    }
+  }
+
+  /**
+   * @brief Append the validity bit of the row about to be appended.
+   */
+  auto appendBit(bool valid) -> void {
+    std::size_t const row = size();
+    if (row % WordBits == 0) {
+      validity_.push_back(0);
+    }
+    validity_.back() |= static_cast<std::uint64_t>(valid) << (row % WordBits);
+  }
+
+  /**
+   * @brief Append the validity bits [@pos, @pos + @count) of @from, or
+   * @count set bits if @from is empty, to the bitmap of the rows from @row.
+   */
+  auto appendBits(std::span<std::uint64_t const> from, std::size_t pos,
+                  std::size_t count, std::size_t row) -> void {
+    validity_.resize(NumWords(row + count), 0);
+    for (std::size_t k = 0; k < count; k += WordBits) {
+      std::size_t const n = std::min(WordBits, count - k);
+      std::uint64_t const bits =
+          from.empty() ? LowBits(n) : ReadBits(from, pos + k, n);
+      std::size_t const w = (row + k) / WordBits;
+      std::size_t const shift = (row + k) % WordBits;
+      validity_[w] |= bits << shift;
+      if (shift != 0 && shift + n > WordBits) {
+        validity_[w + 1] |= bits >> (WordBits - shift);
+      }
+    }
+  }
+
+  /**
+   * @brief Append the values of rows [@first, @last) of @from.
+   */
+  auto appendRows(Column const& from, std::size_t first, std::size_t last)
+      -> void {
+    assert(&from != this);
+    std::size_t const row = size();
+    std::size_t const count = last - first;
+    std::size_t numNulls = 0;
+    if (!from.validity_.empty()) {
+      for (std::size_t k = 0; k < count; k += WordBits) {
+        std::size_t const n = std::min(WordBits, count - k);
+        numNulls += n - std::popcount(ReadBits(from.validity_, first + k, n));
+      }
+    }
+    if (numNulls > 0 && validity_.empty()) {
+      allocateValidity();
+    }
+    values_.insert(values_.end(), from.values_.begin() + first,
+                   from.values_.begin() + last);
+    if (!validity_.empty()) {
+      appendBits(numNulls > 0 ? std::span{from.validity_}
+                              : std::span<std::uint64_t const>{},
+                 first, count, row);
+    }
+    numNulls_ += numNulls;
+  }
+
+  Column<T> values_;
+  std::pmr::vector<std::uint64_t> validity_;
+  std::size_t numNulls_ = 0;
+};
+
+template <typename T>
+struct NonNull<Nullable<T>> {
+  using type = T;
+};
+
+template <typename T>
+inline constexpr bool IsNullable<Nullable<T>> = true;
+
+/**
+ * Optional values produced by expressions, e.g. by collecting a nullable
+ * column, are stored in nullable columns, with std::nullopt as null.
+ */
+template <typename T>
+struct ColumnFor<std::optional<T>> {
+  using type = Nullable<T>;
+};
+
+/**
+ * @brief Returns the values of @column, with T{} in place of nulls for
+ * nullable columns.
+ */
+template <typename T>
+auto DenseValues(Column<T> const& column) noexcept -> auto const& {
+  if constexpr (IsNullable<T>) {
+    return column.values();
+  } else {
+    return column;
+  }
+}
+
+/**
+ * @brief Returns the validity bitmap of @column, empty if it holds no null.
+ */
+template <typename T>
+auto Validity(Column<T> const& column) noexcept
+    -> std::span<std::uint64_t const> {
+  if constexpr (IsNullable<T>) {
+    return column.validity();
+  } else {
+    return {};
+  }
+}
+}  // namespace impl
+}  // namespace df
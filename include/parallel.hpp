@@ -0,0 +1,177 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "execution.hpp"
+#include "reductions.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__clang__)
+#define DF_PRAGMA_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define DF_PRAGMA_IVDEP _Pragma("GCC ivdep")
+#else
+#define DF_PRAGMA_IVDEP
+#endif
+
+namespace df {
+namespace impl {
+/**
+ * @brief Number of bytes of a column processed by a single task, sized to
+ * stay in the L2 cache of a core.
+ */
+inline constexpr std::size_t ChunkBytes = 256 * 1024;
+
+/**
+ * @brief Returns the number of rows per chunk for rows of @rowBytes bytes.
+ */
+constexpr auto ChunkRows(std::size_t rowBytes) noexcept -> std::size_t {
+  return std::max<std::size_t>(ChunkBytes / std::max<std::size_t>(rowBytes, 1),
+                               1);
+}
+
+/**
+ * @brief Call @f(begin, end) on consecutive chunks of [0, @numRows) of
+ * @chunkRows rows, in parallel on the global thread pool.
+ *
+ * The chunks only depend on @numRows and @chunkRows, so per-chunk results
+ * combined in chunk order do not depend on the number of threads.
+ *
+ * @returns The number of chunks.
+ */
+template <typename F>
+auto ForEachChunk(std::size_t numRows, std::size_t chunkRows, F&& f)
+    -> std::size_t {
+  std::size_t const numChunks = (numRows + chunkRows - 1) / chunkRows;
+  ThreadPool::Global().run(numChunks, [&](std::size_t chunk) {
+    std::size_t const begin = chunk * chunkRows;
+    f(begin, std::min(begin + chunkRows, numRows));
+  });
+  return numChunks;
+}
+
+/**
+ * @brief Call @f(i) for every i in [0, @numRows) as allowed by @Policy:
+ * in order on the calling thread, or in chunks of @chunkRows rows on the
+ * thread pool, with the loop over a chunk marked as vectorizable for the
+ * unsequenced policy.
+ */
+template <execution::ExecutionPolicy Policy, typename F>
+auto ForEachIndex(Policy&&, std::size_t numRows, std::size_t chunkRows, F&& f)
+    -> void {
+  using P = std::remove_cvref_t<Policy>;
+  if constexpr (std::is_same_v<P, execution::SequencedPolicy>) {
+    for (std::size_t i = 0; i < numRows; ++i) {
+      f(i);
+    }
+  } else {
+    ForEachChunk(numRows, chunkRows, [&](std::size_t b, std::size_t e) {
+      if constexpr (std::is_same_v<P, execution::ParallelUnsequencedPolicy>) {
+        DF_PRAGMA_IVDEP
+        for (std::size_t i = b; i < e; ++i) {
+          f(i);
+        }
+      } else {
+        for (std::size_t i = b; i < e; ++i) {
+          f(i);
+        }
+      }
+    });
+  }
+}
+
+/**
+ * @brief Parallel counterpart of Sum(). Chunk sums are combined in order,
+ * with Kahan compensation for floating-point types.
+ */
+template <typename T>
+auto ParallelSum(std::span<T const> values) -> SumType<T> {
+  std::size_t const chunkRows = ChunkRows(sizeof(T));
+  std::vector<SumType<T>> partial((values.size() + chunkRows - 1) /
+                                  chunkRows);
+  ForEachChunk(values.size(), chunkRows, [&](std::size_t b, std::size_t e) {
+    partial[b / chunkRows] = Sum(values.subspan(b, e - b));
+  });
+  if constexpr (std::is_floating_point_v<T>) {
+    KahanSum<T> acc;
+    for (T x : partial) {
+      acc.add(x);
+    }
+    return acc.sum;
+  } else {
+    SumType<T> sum = 0;
+    for (auto x : partial) {
+      sum += x;
+    }
+    return sum;
+  }
+}
+
+/**
+ * @brief Parallel counterpart of MinMax().
+ */
+template <bool Max, typename T>
+auto ParallelMinMax(std::span<T const> values) -> T {
+  assert(!values.empty());
+  std::size_t const chunkRows = ChunkRows(sizeof(T));
+  std::vector<T> partial((values.size() + chunkRows - 1) / chunkRows);
+  ForEachChunk(values.size(), chunkRows, [&](std::size_t b, std::size_t e) {
+    partial[b / chunkRows] = MinMax<Max>(values.subspan(b, e - b));
+  });
+  return MinMax<Max>(std::span<T const>{partial});
+}
+
+/**
+ * @brief Parallel sum of squared deviations from the mean.
+ *
+ * Each chunk computes its own mean and sum of squared deviations in two
+ * passes; the chunks are then merged in order with the pairwise update of
+ * Chan et al., so the whole column is read once.
+ */
+template <typename T>
+auto ParallelSumSquaredDeviations(std::span<T const> values) -> double {
+  struct Moments {
+    double count = 0;
+    double mean = 0;
+    double m2 = 0;
+  };
+  std::size_t const chunkRows = ChunkRows(sizeof(T));
+  std::vector<Moments> partial((values.size() + chunkRows - 1) / chunkRows);
+  ForEachChunk(values.size(), chunkRows, [&](std::size_t b, std::size_t e) {
+    auto chunk = values.subspan(b, e - b);
+    double const mean = static_cast<double>(Sum(chunk)) / chunk.size();
+    partial[b / chunkRows] = {static_cast<double>(chunk.size()), mean,
+                              SumSquaredDeviations(chunk, mean)};
+  });
+  Moments total;
+  for (auto const& m : partial) {
+    double const count = total.count + m.count;
+    double const delta = m.mean - total.mean;
+    total.m2 += m.m2 + delta * delta * total.count * m.count / count;
+    total.mean += delta * m.count / count;
+    total.count = count;
+  }
+  return total.m2;
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,293 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "simd.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Type of the sum of a column of @T: @T itself for floating-point
+ * types, and 64-bit integers of the same signedness for integral types.
+ */
+template <typename T>
+using SumType = std::conditional_t<
+    std::is_floating_point_v<T>, T,
+    std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+/**
+ * @brief Kahan-compensated scalar accumulator.
+ */
+template <typename T>
+struct KahanSum {
+  T sum = 0;
+  T compensation = 0;
+
+  auto add(T x) noexcept -> void {
+    T const y = x - compensation;
+    T const t = sum + y;
+    compensation = (t - sum) - y;
+    sum = t;
+  }
+};
+
+/**
+ * @brief Returns the sum of @values.
+ *
+ * Floating-point values are summed with Kahan compensation in every vector
+ * lane, and the lanes are then combined with a compensated scalar sum.
+ * Integers are accumulated in 64 bits.
+ */
+template <typename T>
+auto Sum(std::span<T const> values) noexcept -> SumType<T> {
+  static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                "Sums are defined over arithmetic columns");
+  if constexpr (std::is_floating_point_v<T>) {
+    KahanSum<T> acc;
+    std::size_t i = 0;
+    if constexpr (SimdTraits<T>::Enabled) {
+      using S = SimdTraits<T>;
+      // Two independent accumulators hide the latency of the dependency
+      // chain of the compensated additions.
+      typename S::Reg sum[2] = {S::zero(), S::zero()};
+      typename S::Reg comp[2] = {S::zero(), S::zero()};
+      auto step = [&](int k, typename S::Reg x) {
+        typename S::Reg const y = S::sub(x, comp[k]);
+        typename S::Reg const t = S::add(sum[k], y);
+        comp[k] = S::sub(S::sub(t, sum[k]), y);
+        sum[k] = t;
+      };
+      for (; i + 2 * S::Width <= values.size(); i += 2 * S::Width) {
+        step(0, S::load(values.data() + i));
+        step(1, S::load(values.data() + i + S::Width));
+      }
+      T lanes[S::Width];
+      for (int k = 0; k < 2; ++k) {
+        S::store(lanes, sum[k]);
+        for (T lane : lanes) {
+          acc.add(lane);
+        }
+        S::store(lanes, comp[k]);
+        for (T lane : lanes) {
+          acc.add(-lane);
+        }
+      }
+    }
+    for (; i < values.size(); ++i) {
+      acc.add(values[i]);
+    }
+    return acc.sum;
+  } else {
+    SumType<T> sum = 0;
+    for (T value : values) {
+      sum += value;
+    }
+    return sum;
+  }
+}
+
+/**
+ * @brief Returns the sum of the squared differences between @values and
+ * @mean, compensated like Sum().
+ */
+template <typename T>
+auto SumSquaredDeviations(std::span<T const> values, double mean) noexcept
+    -> double {
+  if constexpr (std::is_floating_point_v<T>) {
+    T const m = static_cast<T>(mean);
+    KahanSum<T> acc;
+    std::size_t i = 0;
+    if constexpr (SimdTraits<T>::Enabled) {
+      using S = SimdTraits<T>;
+      typename S::Reg const vm = S::set1(m);
+      typename S::Reg sum = S::zero();
+      typename S::Reg comp = S::zero();
+      for (; i + S::Width <= values.size(); i += S::Width) {
+        typename S::Reg const d = S::sub(S::load(values.data() + i), vm);
+        typename S::Reg const y = S::sub(S::mul(d, d), comp);
+        typename S::Reg const t = S::add(sum, y);
+        comp = S::sub(S::sub(t, sum), y);
+        sum = t;
+      }
+      T lanes[S::Width];
+      S::store(lanes, sum);
+      for (T lane : lanes) {
+        acc.add(lane);
+      }
+      S::store(lanes, comp);
+      for (T lane : lanes) {
+        acc.add(-lane);
+      }
+    }
+    for (; i < values.size(); ++i) {
+      T const d = values[i] - m;
+      acc.add(d * d);
+    }
+    return acc.sum;
+  } else {
+    double sum = 0;
+    for (T value : values) {
+      double const d = static_cast<double>(value) - mean;
+      sum += d * d;
+    }
+    return sum;
+  }
+}
+
+/**
+ * @brief Returns the smallest (@Max false) or largest (@Max true) element
+ * of the non-empty range @values.
+ */
+template <bool Max, typename T>
+auto MinMax(std::span<T const> values) noexcept -> T {
+  assert(!values.empty());
+  auto pick = [](T const& a, T const& b) -> T const& {
+    return Max ? std::max(a, b) : std::min(a, b);
+  };
+  T result = values[0];
+  std::size_t i = 0;
+  if constexpr (SimdTraits<T>::Enabled) {
+    using S = SimdTraits<T>;
+    if (values.size() >= S::Width) {
+      typename S::Reg acc = S::load(values.data());
+      for (i = S::Width; i + S::Width <= values.size(); i += S::Width) {
+        typename S::Reg const x = S::load(values.data() + i);
+        acc = Max ? S::max(acc, x) : S::min(acc, x);
+      }
+      T lanes[S::Width];
+      S::store(lanes, acc);
+      for (T lane : lanes) {
+        result = pick(result, lane);
+      }
+    }
+  }
+  for (; i < values.size(); ++i) {
+    result = pick(result, values[i]);
+  }
+  return result;
+}
+
+/**
+ * @brief Call @dense with every run of consecutive valid values of @values,
+ * and @partial with every other block of up to 64 values holding valid ones
+ * along with its word of validity bits, as given by the validity bitmap
+ * @validity (bit i % 64 of word i / 64 set if value i is valid; empty if all
+ * the values are). The bitmap is read a word at a time, so that runs of
+ * valid values are reduced with vector code and blocks without valid values
+ * are skipped.
+ */
+template <typename T, typename Dense, typename Partial>
+auto ForEachValid(std::span<T const> values,
+                  std::span<std::uint64_t const> validity, Dense&& dense,
+                  Partial&& partial) -> void {
+  constexpr std::size_t WordBits = 64;
+  if (validity.empty()) {
+    if (!values.empty()) {
+      dense(values);
+    }
+    return;
+  }
+  std::size_t const n = values.size();
+  std::size_t run = 0;
+  for (std::size_t w = 0; w < validity.size(); ++w) {
+    std::size_t const base = w * WordBits;
+    std::size_t const size = std::min(WordBits, n - base);
+    std::uint64_t const all =
+        size == WordBits ? ~std::uint64_t{0} : (std::uint64_t{1} << size) - 1;
+    if (validity[w] == all) {
+      continue;
+    }
+    if (run < base) {
+      dense(values.subspan(run, base - run));
+    }
+    run = base + size;
+    if (validity[w] != 0) {
+      partial(values.subspan(base, size), validity[w]);
+    }
+  }
+  if (run < n) {
+    dense(values.subspan(run));
+  }
+}
+
+/**
+ * @brief Returns the smallest (@Max false) or largest (@Max true) valid
+ * value of @values, as given by the validity bitmap @validity. There must be
+ * at least one.
+ *
+ * Blocks holding nulls replace them with the identity of the reduction
+ * without branching, which keeps the loop vectorizable.
+ */
+template <bool Max, typename T>
+auto MinMaxValid(std::span<T const> values,
+                 std::span<std::uint64_t const> validity) noexcept -> T {
+  T const identity = Max ? std::numeric_limits<T>::lowest()
+                         : std::numeric_limits<T>::max();
+  T result = identity;
+  bool first = true;
+  auto pick = [&](T x) {
+    result = first ? x : Max ? std::max(result, x) : std::min(result, x);
+    first = false;
+  };
+  ForEachValid(
+      values, validity, [&](std::span<T const> run) { pick(MinMax<Max>(run)); },
+      [&](std::span<T const> block, std::uint64_t word) {
+        T m = identity;
+        for (std::size_t k = 0; k < block.size(); ++k) {
+          T const x = (word >> k) & 1 ? block[k] : identity;
+          m = Max ? std::max(m, x) : std::min(m, x);
+        }
+        pick(m);
+      });
+  assert(!first);
+  return result;
+}
+
+/**
+ * @brief Returns the sum of the squared differences between the valid
+ * values of @values, as given by the validity bitmap @validity, and @mean.
+ */
+template <typename T>
+auto SumSquaredDeviationsValid(std::span<T const> values,
+                               std::span<std::uint64_t const> validity,
+                               double mean) noexcept -> double {
+  KahanSum<double> acc;
+  ForEachValid(
+      values, validity,
+      [&](std::span<T const> run) {
+        acc.add(SumSquaredDeviations(run, mean));
+      },
+      [&](std::span<T const> block, std::uint64_t word) {
+        double sum = 0;
+        for (std::size_t k = 0; k < block.size(); ++k) {
+          double const d = static_cast<double>(block[k]) - mean;
+          sum += (word >> k) & 1 ? d * d : 0.0;
+        }
+        acc.add(sum);
+      });
+  return acc.sum;
+}
+}  // namespace impl
+}  // namespace df
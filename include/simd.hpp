@@ -0,0 +1,250 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <cstddef>
+#include <cstdint>
+
+namespace df {
+namespace impl {
+/**
+ * @brief Comparison operators with a vectorized implementation.
+ */
+enum class CmpOp { Lt, Le, Gt, Ge, Eq, Ne };
+
+/**
+ * @brief Thin wrappers over the vector registers holding values of type @T,
+ * for the widest instruction set enabled at compile time.
+ *
+ * Specializations define `Reg`, `Width` (values per register) and the
+ * operations load, store, set1, min, max and compare, which returns one bit
+ * per lane; floating-point ones also define zero, add, sub and mul.
+ * `Enabled` is false when no vector instructions are available for @T, in
+ * which case callers fall back to scalar loops.
+ */
+template <typename T>
+struct SimdTraits {
+  static constexpr bool Enabled = false;
+};
+
+#if defined(__AVX__)
+template <>
+struct SimdTraits<float> {
+  static constexpr bool Enabled = true;
+  using Reg = __m256;
+  static constexpr std::size_t Width = 8;
+  static auto load(float const* p) noexcept -> Reg {
+    return _mm256_loadu_ps(p);
+  }
+  static auto store(float* p, Reg v) noexcept -> void {
+    _mm256_storeu_ps(p, v);
+  }
+  static auto set1(float x) noexcept -> Reg { return _mm256_set1_ps(x); }
+  static auto zero() noexcept -> Reg { return _mm256_setzero_ps(); }
+  static auto add(Reg a, Reg b) noexcept -> Reg { return _mm256_add_ps(a, b); }
+  static auto sub(Reg a, Reg b) noexcept -> Reg { return _mm256_sub_ps(a, b); }
+  static auto mul(Reg a, Reg b) noexcept -> Reg { return _mm256_mul_ps(a, b); }
+  static auto min(Reg a, Reg b) noexcept -> Reg { return _mm256_min_ps(a, b); }
+  static auto max(Reg a, Reg b) noexcept -> Reg { return _mm256_max_ps(a, b); }
+  template <CmpOp Op>
+  static auto compare(Reg a, Reg b) noexcept -> unsigned {
+    constexpr int Predicate = Op == CmpOp::Lt   ? _CMP_LT_OQ
+                              : Op == CmpOp::Le ? _CMP_LE_OQ
+                              : Op == CmpOp::Gt ? _CMP_GT_OQ
+                              : Op == CmpOp::Ge ? _CMP_GE_OQ
+                              : Op == CmpOp::Eq ? _CMP_EQ_OQ
+                                                : _CMP_NEQ_UQ;
+    return _mm256_movemask_ps(_mm256_cmp_ps(a, b, Predicate));
+  }
+};
+
+template <>
+struct SimdTraits<double> {
+  static constexpr bool Enabled = true;
+  using Reg = __m256d;
+  static constexpr std::size_t Width = 4;
+  static auto load(double const* p) noexcept -> Reg {
+    return _mm256_loadu_pd(p);
+  }
+  static auto store(double* p, Reg v) noexcept -> void {
+    _mm256_storeu_pd(p, v);
+  }
+  static auto set1(double x) noexcept -> Reg { return _mm256_set1_pd(x); }
+  static auto zero() noexcept -> Reg { return _mm256_setzero_pd(); }
+  static auto add(Reg a, Reg b) noexcept -> Reg { return _mm256_add_pd(a, b); }
+  static auto sub(Reg a, Reg b) noexcept -> Reg { return _mm256_sub_pd(a, b); }
+  static auto mul(Reg a, Reg b) noexcept -> Reg { return _mm256_mul_pd(a, b); }
+  static auto min(Reg a, Reg b) noexcept -> Reg { return _mm256_min_pd(a, b); }
+  static auto max(Reg a, Reg b) noexcept -> Reg { return _mm256_max_pd(a, b); }
+  template <CmpOp Op>
+  static auto compare(Reg a, Reg b) noexcept -> unsigned {
+    constexpr int Predicate = Op == CmpOp::Lt   ? _CMP_LT_OQ
+                              : Op == CmpOp::Le ? _CMP_LE_OQ
+                              : Op == CmpOp::Gt ? _CMP_GT_OQ
+                              : Op == CmpOp::Ge ? _CMP_GE_OQ
+                              : Op == CmpOp::Eq ? _CMP_EQ_OQ
+                                                : _CMP_NEQ_UQ;
+    return _mm256_movemask_pd(_mm256_cmp_pd(a, b, Predicate));
+  }
+};
+#elif defined(__SSE2__)
+template <>
+struct SimdTraits<float> {
+  static constexpr bool Enabled = true;
+  using Reg = __m128;
+  static constexpr std::size_t Width = 4;
+  static auto load(float const* p) noexcept -> Reg { return _mm_loadu_ps(p); }
+  static auto store(float* p, Reg v) noexcept -> void { _mm_storeu_ps(p, v); }
+  static auto set1(float x) noexcept -> Reg { return _mm_set1_ps(x); }
+  static auto zero() noexcept -> Reg { return _mm_setzero_ps(); }
+  static auto add(Reg a, Reg b) noexcept -> Reg { return _mm_add_ps(a, b); }
+  static auto sub(Reg a, Reg b) noexcept -> Reg { return _mm_sub_ps(a, b); }
+  static auto mul(Reg a, Reg b) noexcept -> Reg { return _mm_mul_ps(a, b); }
+  static auto min(Reg a, Reg b) noexcept -> Reg { return _mm_min_ps(a, b); }
+  static auto max(Reg a, Reg b) noexcept -> Reg { return _mm_max_ps(a, b); }
+  template <CmpOp Op>
+  static auto compare(Reg a, Reg b) noexcept -> unsigned {
+    Reg m;
+    if constexpr (Op == CmpOp::Lt) {
+      m = _mm_cmplt_ps(a, b);
+    } else if constexpr (Op == CmpOp::Le) {
+      m = _mm_cmple_ps(a, b);
+    } else if constexpr (Op == CmpOp::Gt) {
+      m = _mm_cmpgt_ps(a, b);
+    } else if constexpr (Op == CmpOp::Ge) {
+      m = _mm_cmpge_ps(a, b);
+    } else if constexpr (Op == CmpOp::Eq) {
+      m = _mm_cmpeq_ps(a, b);
+    } else {
+      m = _mm_cmpneq_ps(a, b);
+    }
+    return _mm_movemask_ps(m);
+  }
+};
+
+template <>
+struct SimdTraits<double> {
+  static constexpr bool Enabled = true;
+  using Reg = __m128d;
+  static constexpr std::size_t Width = 2;
+  static auto load(double const* p) noexcept -> Reg { return _mm_loadu_pd(p); }
+  static auto store(double* p, Reg v) noexcept -> void { _mm_storeu_pd(p, v); }
+  static auto set1(double x) noexcept -> Reg { return _mm_set1_pd(x); }
+  static auto zero() noexcept -> Reg { return _mm_setzero_pd(); }
+  static auto add(Reg a, Reg b) noexcept -> Reg { return _mm_add_pd(a, b); }
+  static auto sub(Reg a, Reg b) noexcept -> Reg { return _mm_sub_pd(a, b); }
+  static auto mul(Reg a, Reg b) noexcept -> Reg { return _mm_mul_pd(a, b); }
+  static auto min(Reg a, Reg b) noexcept -> Reg { return _mm_min_pd(a, b); }
+  static auto max(Reg a, Reg b) noexcept -> Reg { return _mm_max_pd(a, b); }
+  template <CmpOp Op>
+  static auto compare(Reg a, Reg b) noexcept -> unsigned {
+    Reg m;
+    if constexpr (Op == CmpOp::Lt) {
+      m = _mm_cmplt_pd(a, b);
+    } else if constexpr (Op == CmpOp::Le) {
+      m = _mm_cmple_pd(a, b);
+    } else if constexpr (Op == CmpOp::Gt) {
+      m = _mm_cmpgt_pd(a, b);
+    } else if constexpr (Op == CmpOp::Ge) {
+      m = _mm_cmpge_pd(a, b);
+    } else if constexpr (Op == CmpOp::Eq) {
+      m = _mm_cmpeq_pd(a, b);
+    } else {
+      m = _mm_cmpneq_pd(a, b);
+    }
+    return _mm_movemask_pd(m);
+  }
+};
+#endif
+
+#if defined(__AVX2__)
+template <>
+struct SimdTraits<std::int32_t> {
+  static constexpr bool Enabled = true;
+  using Reg = __m256i;
+  static constexpr std::size_t Width = 8;
+  static auto load(std::int32_t const* p) noexcept -> Reg {
+    return _mm256_loadu_si256(reinterpret_cast<Reg const*>(p));
+  }
+  static auto store(std::int32_t* p, Reg v) noexcept -> void {
+    _mm256_storeu_si256(reinterpret_cast<Reg*>(p), v);
+  }
+  static auto set1(std::int32_t x) noexcept -> Reg {
+    return _mm256_set1_epi32(x);
+  }
+  static auto min(Reg a, Reg b) noexcept -> Reg {
+    return _mm256_min_epi32(a, b);
+  }
+  static auto max(Reg a, Reg b) noexcept -> Reg {
+    return _mm256_max_epi32(a, b);
+  }
+  template <CmpOp Op>
+  static auto compare(Reg a, Reg b) noexcept -> unsigned {
+    Reg m;
+    if constexpr (Op == CmpOp::Lt || Op == CmpOp::Ge) {
+      m = _mm256_cmpgt_epi32(b, a);
+    } else if constexpr (Op == CmpOp::Gt || Op == CmpOp::Le) {
+      m = _mm256_cmpgt_epi32(a, b);
+    } else {
+      m = _mm256_cmpeq_epi32(a, b);
+    }
+    unsigned bits = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+    if constexpr (Op == CmpOp::Ge || Op == CmpOp::Le || Op == CmpOp::Ne) {
+      bits ^= (1u << Width) - 1;
+    }
+    return bits;
+  }
+};
+#elif defined(__SSE4_1__)
+template <>
+struct SimdTraits<std::int32_t> {
+  static constexpr bool Enabled = true;
+  using Reg = __m128i;
+  static constexpr std::size_t Width = 4;
+  static auto load(std::int32_t const* p) noexcept -> Reg {
+    return _mm_loadu_si128(reinterpret_cast<Reg const*>(p));
+  }
+  static auto store(std::int32_t* p, Reg v) noexcept -> void {
+    _mm_storeu_si128(reinterpret_cast<Reg*>(p), v);
+  }
+  static auto set1(std::int32_t x) noexcept -> Reg { return _mm_set1_epi32(x); }
+  static auto min(Reg a, Reg b) noexcept -> Reg { return _mm_min_epi32(a, b); }
+  static auto max(Reg a, Reg b) noexcept -> Reg { return _mm_max_epi32(a, b); }
+  template <CmpOp Op>
+  static auto compare(Reg a, Reg b) noexcept -> unsigned {
+    Reg m;
+    if constexpr (Op == CmpOp::Lt || Op == CmpOp::Ge) {
+      m = _mm_cmpgt_epi32(b, a);
+    } else if constexpr (Op == CmpOp::Gt || Op == CmpOp::Le) {
+      m = _mm_cmpgt_epi32(a, b);
+    } else {
+      m = _mm_cmpeq_epi32(a, b);
+    }
+    unsigned bits = _mm_movemask_ps(_mm_castsi128_ps(m));
+    if constexpr (Op == CmpOp::Ge || Op == CmpOp::Le || Op == CmpOp::Ne) {
+      bits ^= (1u << Width) - 1;
+    }
+    return bits;
+  }
+};
+#endif
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,202 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+
+namespace df {
+namespace impl {
+/**
+ * @brief Whether keys of type @T are sorted by radix sort rather than by
+ * comparisons.
+ */
+template <typename T>
+inline constexpr bool IsRadixSortable =
+    std::is_integral_v<T> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double>;
+
+/**
+ * @brief Unsigned integer type whose order encodes the order of @T.
+ */
+template <typename T>
+using RadixKeyType = std::conditional_t<
+    std::is_same_v<T, bool>, std::uint8_t,
+    std::conditional_t<
+        std::is_same_v<T, float>, std::uint32_t,
+        std::conditional_t<std::is_same_v<T, double>, std::uint64_t,
+                           std::make_unsigned_t<std::conditional_t<
+                               std::is_integral_v<T>, T, int>>>>>;
+
+/**
+ * @brief Map @x to an unsigned integer with the same order.
+ *
+ * Signed integers have their sign bit flipped. Floating-point values have
+ * their sign bit flipped if positive and all bits flipped if negative, which
+ * orders -0 before +0 and NaNs after infinities of the same sign.
+ */
+template <typename T>
+constexpr auto RadixKey(T x) noexcept -> RadixKeyType<T> {
+  using U = RadixKeyType<T>;
+  if constexpr (std::is_floating_point_v<T>) {
+    U const bits = std::bit_cast<U>(x);
+    U const sign = U{1} << (sizeof(U) * 8 - 1);
+    return (bits & sign) ? ~bits : bits | sign;
+  } else if constexpr (std::is_signed_v<T>) {
+    return static_cast<U>(x) ^ (U{1} << (sizeof(U) * 8 - 1));
+  } else {
+    return static_cast<U>(x);
+  }
+}
+
+/**
+ * @brief Stably reorder @perm so that the values of @column it refers to are
+ * in ascending order, with an LSD radix sort on 8-bit digits.
+ *
+ * The histograms of all digits are built in a single pass over the keys, and
+ * digits that are equal across all keys are skipped.
+ */
+template <typename T>
+auto RadixSortPermutation(Column<T> const& column,
+                          std::vector<std::size_t>& perm) -> void {
+  using U = RadixKeyType<T>;
+  constexpr std::size_t NumDigits = sizeof(U);
+  std::size_t const n = perm.size();
+  std::vector<U> keys(n);
+  std::vector<U> keysTmp(n);
+  std::vector<std::size_t> permTmp(n);
+  std::vector<std::array<std::size_t, 256>> counts(NumDigits);
+  for (std::size_t i = 0; i < n; ++i) {
+    U const key = RadixKey<T>(column[perm[i]]);
+    keys[i] = key;
+    for (std::size_t d = 0; d < NumDigits; ++d) {
+      ++counts[d][(key >> (8 * d)) & 0xff];
+    }
+  }
+  for (std::size_t d = 0; d < NumDigits; ++d) {
+    auto& count = counts[d];
+    if (std::find(count.begin(), count.end(), n) != count.end()) {
+      continue;
+    }
+    std::size_t offset = 0;
+    for (auto& c : count) {
+      offset += std::exchange(c, offset);
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      std::size_t const pos = count[(keys[i] >> (8 * d)) & 0xff]++;
+      keysTmp[pos] = keys[i];
+      permTmp[pos] = perm[i];
+    }
+    keys.swap(keysTmp);
+    perm.swap(permTmp);
+  }
+}
+
+/**
+ * @brief Stably reorder @perm so that the values of @column it refers to are
+ * in ascending order: radix sort for arithmetic types, a comparison sort
+ * otherwise.
+ *
+ * Categorical columns sort their dictionary, then radix sort the rank of
+ * the value of every row, so that values are only compared once per
+ * distinct value.
+ */
+template <typename T>
+auto SortPermutation(Column<T> const& column,
+                     std::vector<std::size_t>& perm) -> void {
+  if constexpr (IsCategorical<T>) {
+    using Code = typename Column<T>::code_type;
+    auto const& dictionary = column.dictionary();
+    std::vector<std::size_t> order(dictionary.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    SortPermutation(dictionary, order);
+    std::vector<Code> rankOf(order.size());
+    for (std::size_t r = 0; r < order.size(); ++r) {
+      rankOf[order[r]] = static_cast<Code>(r);
+    }
+    Column<Code> ranks(column.size());
+    for (std::size_t i = 0; i < ranks.size(); ++i) {
+      ranks[i] = rankOf[column.code(i)];
+    }
+    RadixSortPermutation(ranks, perm);
+  } else if constexpr (IsRadixSortable<T>) {
+    RadixSortPermutation(column, perm);
+  } else {
+    std::stable_sort(perm.begin(), perm.end(),
+                     [&](std::size_t a, std::size_t b) {
+                       return column[a] < column[b];
+                     });
+  }
+}
+
+/**
+ * @brief Returns the permutation sorting @columns by column @Col, then by
+ * the columns @Cols to break ties. Ties on all keys keep their order.
+ */
+template <std::size_t Col, std::size_t... Cols, typename... Ts>
+auto ArgSort(std::tuple<Column<Ts>...> const& columns)
+    -> std::vector<std::size_t> {
+  std::vector<std::size_t> perm(std::get<0>(columns).size());
+  std::iota(perm.begin(), perm.end(), std::size_t{0});
+  // Stable sorts from the least significant key to the most significant one.
+  static constexpr std::size_t Keys[] = {Col, Cols...};
+  constexpr std::size_t NumKeys = 1 + sizeof...(Cols);
+  [&]<std::size_t... Ks>(std::index_sequence<Ks...>) {
+    (SortPermutation(std::get<Keys[NumKeys - 1 - Ks]>(columns), perm), ...);
+  }(std::make_index_sequence<NumKeys>{});
+  return perm;
+}
+
+/**
+ * @brief Reorder @column so that its i-th value is the @perm[i]-th one.
+ * Categorical columns reorder their codes.
+ */
+template <typename T>
+auto Permute(Column<T>& column, std::span<std::size_t const> perm)
+    -> void {
+  assert(column.size() == perm.size());
+  if constexpr (IsCategorical<T>) {
+    Permute(column.codes(), perm);
+  } else {
+    Column<T> permuted{column.get_allocator()};
+    permuted.reserve(column.capacity());
+    for (std::size_t i : perm) {
+      permuted.push_back(std::move(column[i]));
+    }
+    column.swap(permuted);
+  }
+}
+
+template <typename... Ts, std::size_t... Is>
+auto PermuteColumns(std::tuple<Column<Ts>...>& columns,
+                    std::span<std::size_t const> perm,
+                    std::index_sequence<Is...>) -> void {
+  (Permute(std::get<Is>(columns), perm), ...);
+}
+}  // namespace impl
+}  // namespace df
@@ -0,0 +1,207 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "column.hpp"
+
+namespace df {
+/**
+ * @brief Column type holding strings stored contiguously, e.g.
+ * `DataFrame<int, str>`.
+ *
+ * The bytes of all the values of the column are kept in a single buffer,
+ * delimited by an array of 64-bit offsets, so that appending, copying and
+ * moving columns is mostly memcpy, and a value costs 8 bytes on top of its
+ * characters. Values are appended and read as `std::string_view`s, which
+ * refer to the buffer and are valid until the column is modified.
+ */
+struct str {};
+
+namespace impl {
+/**
+ * @brief Storage of a column of df::str: the bytes of all the values, and
+ * the offset in the bytes of the start of every value followed by the
+ * offset of the end of the last one.
+ *
+ * The offsets are empty rather than holding a single 0 while the column has
+ * never held a value, so that empty columns do not allocate. Values can only
+ * be appended at the end.
+ */
+template <>
+class Column<str> {
+ public:
+  using value_type = std::string_view;
+  using reference = std::string_view;
+  using const_reference = std::string_view;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+
+  using const_iterator = ColumnIterator<Column>;
+  using iterator = const_iterator;
+
+  Column() noexcept = default;
+
+  explicit Column(allocator_type alloc) noexcept
+      : offsets_{alloc}, bytes_{alloc} {}
+
+  Column(Column const& other, allocator_type alloc) : Column{alloc} {
+    insert(end(), other.begin(), other.end());
+  }
+
+  Column(Column&& other, allocator_type alloc)
+      : offsets_{std::move(other.offsets_), alloc},
+        bytes_{std::move(other.bytes_), alloc} {}
+
+  auto size() const noexcept -> std::size_t {
+    return offsets_.empty() ? 0 : offsets_.size() - 1;
+  }
+
+  auto empty() const noexcept -> bool { return size() == 0; }
+
+  auto capacity() const noexcept -> std::size_t {
+    return offsets_.capacity() == 0 ? 0 : offsets_.capacity() - 1;
+  }
+
+  /**
+   * @brief Make room for @numValues values. The bytes are reserved as they
+   * are appended.
+   */
+  auto reserve(std::size_t numValues) -> void {
+    offsets_.reserve(numValues + 1);
+  }
+
+  auto clear() noexcept -> void {
+    offsets_.clear();
+    bytes_.clear();
+  }
+
+  auto get_allocator() const noexcept -> allocator_type {
+    return bytes_.get_allocator();
+  }
+
+  auto operator[](std::size_t i) const noexcept -> std::string_view {
+    return {bytes_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]};
+  }
+
+  auto begin() const noexcept -> const_iterator { return {this, 0}; }
+
+  auto end() const noexcept -> const_iterator { return {this, size()}; }
+
+  auto push_back(std::string_view value) -> void {
+    if (offsets_.empty()) {
+      offsets_.push_back(0);
+    }
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+    offsets_.push_back(bytes_.size());
+  }
+
+  /**
+   * @brief Append the string view constructed from @args.
+   */
+  template <typename... Args>
+  auto emplace_back(Args&&... args) -> std::string_view {
+    push_back(std::string_view(std::forward<Args>(args)...));
+    return (*this)[size() - 1];
+  }
+
+  /**
+   * @brief Append the values of [@first, @last), which must not belong to
+   * this column. @pos must be end().
+   *
+   * Values of another df::str column, possibly through move iterators, are
+   * appended with a single copy of their bytes.
+   */
+  template <std::input_iterator It>
+  auto insert(const_iterator pos, It first, It last) -> const_iterator {
+    assert(pos == end());
+    (void)pos;
+    std::size_t const row = size();
+    if constexpr (std::is_same_v<It, std::move_iterator<const_iterator>>) {
+      insert(pos, first.base(), last.base());
+    } else if constexpr (std::is_same_v<It, const_iterator>) {
+      appendRows(first.column(), first.row(), last.row());
+    } else {
+      if constexpr (std::forward_iterator<It>) {
+        std::size_t numBytes = 0;
+        for (It it = first; it != last; ++it) {
+          numBytes += std::string_view(*it).size();
+        }
+        bytes_.reserve(bytes_.size() + numBytes);
+      }
+      for (; first != last; ++first) {
+        push_back(std::string_view(*first));
+      }
+    }
+    return {this, row};
+  }
+
+  auto swap(Column& other) noexcept -> void {
+    offsets_.swap(other.offsets_);
+    bytes_.swap(other.bytes_);
+  }
+
+ private:
+  /**
+   * @brief Append the values of rows [@first, @last) of @from.
+   */
+  auto appendRows(Column const& from, std::size_t first, std::size_t last)
+      -> void {
+    assert(&from != this);
+    if (first == last) {
+      return;
+    }
+    if (offsets_.empty()) {
+      offsets_.push_back(0);
+    }
+    std::uint64_t const begin = from.offsets_[first];
+    std::uint64_t const shift = bytes_.size() - begin;
+    bytes_.insert(bytes_.end(), from.bytes_.begin() + begin,
+                  from.bytes_.begin() + from.offsets_[last]);
+    std::size_t const base = offsets_.size();
+    std::size_t const n = last - first;
+    offsets_.resize(base + n);
+    std::uint64_t const* in = from.offsets_.data() + first + 1;
+    std::uint64_t* out = offsets_.data() + base;
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = in[i] + shift;
+    }
+  }
+
+  std::pmr::vector<std::uint64_t> offsets_;
+  std::pmr::vector<char> bytes_;
+};
+
+template <>
+inline constexpr bool IsString<str> = true;
+
+template <>
+struct ColumnFor<std::string_view> {
+  using type = str;
+};
+}  // namespace impl
+}  // namespace df
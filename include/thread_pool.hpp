@@ -0,0 +1,180 @@
+/**
+ * Copyright (C) 2023 Sebastiano Smaniotto - All rights reserved
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace df {
+namespace impl {
+/**
+ * @brief Fixed set of worker threads running batches of indexed tasks.
+ *
+ * The thread calling run() works on its own batch alongside the workers, so
+ * batches submitted from several threads make progress concurrently. Calls
+ * made from within a task run inline, which makes nested parallelism safe.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief Start @numThreads - 1 workers; the caller of run() is the last
+   * thread.
+   */
+  explicit ThreadPool(unsigned numThreads) {
+    for (unsigned i = 1; i < numThreads; ++i) {
+      workers_.emplace_back([this] { workerLoop(); });
+    }
+  }
+
+  ~ThreadPool() noexcept {
+    {
+      std::lock_guard lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(ThreadPool const&) = delete;
+  auto operator=(ThreadPool const&) -> ThreadPool& = delete;
+
+  /**
+   * @brief Returns the pool shared by the whole library, with one thread per
+   * hardware core.
+   */
+  static auto Global() -> ThreadPool& {
+    static ThreadPool pool{std::max(1u, std::thread::hardware_concurrency())};
+    return pool;
+  }
+
+  /**
+   * @brief Returns the number of threads running tasks, the caller included.
+   */
+  auto size() const noexcept -> std::size_t { return workers_.size() + 1; }
+
+  /**
+   * @brief Call @task(i) for every i in [0, @numTasks) and wait for all the
+   * calls to return. The first exception thrown by a task is rethrown.
+   */
+  auto run(std::size_t numTasks, std::function<void(std::size_t)> task)
+      -> void {
+    if (numTasks <= 1 || workers_.empty() || InsideTask()) {
+      for (std::size_t i = 0; i < numTasks; ++i) {
+        task(i);
+      }
+      return;
+    }
+    auto batch = std::make_shared<Batch>(std::move(task), numTasks);
+    {
+      std::lock_guard lock{mutex_};
+      queue_.push_back(batch);
+    }
+    cv_.notify_all();
+    work(*batch);
+    {
+      std::unique_lock lock{batch->mutex};
+      batch->finished.wait(lock, [&] { return batch->done == numTasks; });
+    }
+    {
+      std::lock_guard lock{mutex_};
+      std::erase(queue_, batch);
+    }
+    if (batch->error) {
+      std::rethrow_exception(batch->error);
+    }
+  }
+
+ private:
+  struct Batch {
+    Batch(std::function<void(std::size_t)> task, std::size_t numTasks)
+        : task{std::move(task)}, numTasks{numTasks} {}
+
+    std::function<void(std::size_t)> task;
+    std::size_t numTasks;
+    std::atomic<std::size_t> next{0};
+    std::size_t done = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable finished;
+  };
+
+  static auto InsideTask() noexcept -> bool& {
+    thread_local bool insideTask = false;
+    return insideTask;
+  }
+
+  /**
+   * @brief Run tasks of @batch until none are left to claim.
+   */
+  static auto work(Batch& batch) -> void {
+    InsideTask() = true;
+    for (std::size_t i = batch.next++; i < batch.numTasks; i = batch.next++) {
+      std::exception_ptr error;
+      try {
+        batch.task(i);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard lock{batch.mutex};
+      if (error && !batch.error) {
+        batch.error = error;
+      }
+      if (++batch.done == batch.numTasks) {
+        batch.finished.notify_all();
+      }
+    }
+    InsideTask() = false;
+  }
+
+  auto workerLoop() -> void {
+    for (;;) {
+      std::shared_ptr<Batch> batch;
+      {
+        std::unique_lock lock{mutex_};
+        cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+        if (stop_) {
+          return;
+        }
+        batch = queue_.front();
+        if (batch->next >= batch->numTasks) {
+          queue_.pop_front();
+          continue;
+        }
+      }
+      work(*batch);
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::shared_ptr<Batch>> queue_;
+  bool stop_ = false;
+  std::vector<std::thread> workers_;
+};
+}  // namespace impl
+}  // namespace df
@@ -14,12 +14,17 @@
  * You should have received a copy of the GNU General Public License
  * along with this program. If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory_resource>
 #include <random>
 #include <string>
 
+#include "csv.hpp"
 #include "dataframe.hpp"
+#include "join.hpp"
 
 namespace {
 constexpr int NUM = 10'000'000;
@@ -165,6 +170,17 @@ int main(void) {
   for (auto it = df3.begin(); it != df3.end(); ++it) {
     PrintTuple(*it);
   }
+  std::cout << "df3 sorted by descending column 1 with std::ranges::sort:\n";
+  auto index3 = df3.sortedIndex<0>();
+  std::ranges::sort(df3, std::ranges::greater{},
+                    [](auto const& row) { return std::get<1>(row); });
+  for (auto const row : df3) {
+    PrintTuple(row);
+  }
+  // Sorting through iterators is not seen by the indexes of df3.
+  index3.rebuild();
+  std::cout << "Row of value 2 in column 0 after rebuild: "
+            << index3.equal(2)[0] << "\n";
   std::cout << "\n";
 
   std::cout << "df::DataFrame<int, double, char>, append move\n";
@@ -217,6 +233,55 @@ int main(void) {
   df7.append(std::move(df5));
   std::cout << "\n";
 
+  std::cout << "df::readCsv<float, float, float, float, std::string>, "
+               "data/iris.csv\n";
+  auto iris = df::readCsv<float, float, float, float, std::string>(
+      "data/iris.csv");
+  std::cout << "Rows read: " << iris.size() << "\n";
+  std::cout << "First row: ";
+  PrintTuple(iris.get(0));
+  std::cout << "Last row: ";
+  PrintTuple(iris.get(iris.size() - 1));
+  std::cout << "\n";
+
+  std::cout << "df::readCsv<float, float, float, float, df::cat>, "
+               "data/iris.csv\n";
+  auto irisCat =
+      df::readCsv<float, float, float, float, df::cat>("data/iris.csv");
+  std::cout << "Classes: " << irisCat.numCategories<4>() << " (";
+  for (std::size_t c = 0; c < irisCat.numCategories<4>(); ++c) {
+    std::cout << irisCat.category<4>(c)
+              << (c + 1 < irisCat.numCategories<4>() ? ", " : ")\n");
+  }
+  std::cout << "\n";
+
+  std::cout << "df::innerJoin, df::leftJoin, df::mergeJoin, df::asofJoin\n";
+  df::DataFrame<int, std::string> trades;
+  trades.append(1, "buy");
+  trades.append(3, "sell");
+  trades.append(4, "buy");
+  df::DataFrame<int, double> quotes;
+  quotes.append(0, 9.5);
+  quotes.append(1, 10.);
+  quotes.append(3, 10.5);
+  std::cout << "Inner join:\n";
+  for (auto const row : df::innerJoin<0, 0>(trades, quotes)) {
+    PrintTuple(row);
+  }
+  std::cout << "Left join:\n";
+  for (auto const row : df::leftJoin<0, 0>(trades, quotes)) {
+    PrintTuple(row);
+  }
+  std::cout << "Merge join: " << df::mergeJoin<0, 0>(trades, quotes).size()
+            << " rows, semi join: " << df::semiJoin<0, 0>(trades, quotes).size()
+            << " rows, anti join: " << df::antiJoin<0, 0>(trades, quotes).size()
+            << " rows\n";
+  std::cout << "As-of join:\n";
+  for (auto const row : df::asofJoin<0, 0>(trades, quotes)) {
+    PrintTuple(row);
+  }
+  std::cout << "\n";
+
   {
     std::cout << "Speed test, " << ShortNumber(NUM)
               << " elements (int, float)\n";
@@ -243,6 +308,15 @@ int main(void) {
             .count();
     std::cout << " Elapsed time: " << elapsed << " ms\n";
 
+    df::DataFrame<int, float> dfc;
+    std::cout << "Insertion by columns...";
+    start = std::chrono::high_resolution_clock::now();
+    dfc.appendColumns(is, fs);
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms\n";
+
     std::cout << "Insertion by move...";
     start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < NUM; ++i) {
@@ -272,6 +346,146 @@ int main(void) {
     elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
                   .count();
     std::cout << " Elapsed time: " << elapsed << " ms\n";
+
+    std::vector<std::size_t> rows(NUM);
+    std::uniform_int_distribution<std::size_t> rr{0, NUM - 1};
+    for (auto& row : rows) {
+      row = rr(mt);
+    }
+    df::DataFrame<int, float> dfr;
+    dfr.reserve(NUM);
+    std::cout << "Random access to rows with get...";
+    start = std::chrono::high_resolution_clock::now();
+    for (std::size_t row : rows) {
+      dfr.append(df3.get(row));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms\n";
+
+    std::cout << "Random access to rows with take...";
+    start = std::chrono::high_resolution_clock::now();
+    df::DataFrame<int, float> const dft = df3.take(rows);
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms ("
+              << (std::ranges::equal(dft.column<0>(), dfr.column<0>()) &&
+                          std::ranges::equal(dft.column<1>(), dfr.column<1>())
+                      ? "matching"
+                      : "NOT matching")
+              << ")\n";
+
+    std::cout << "Write rows back with scatter...";
+    start = std::chrono::high_resolution_clock::now();
+    df3.scatter(rows, dft);
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms ("
+              << (std::ranges::equal(df3.column<0>(), df2.column<0>()) &&
+                          std::ranges::equal(df3.column<1>(), df2.column<1>())
+                      ? "matching"
+                      : "NOT matching")
+              << ")\n";
+
+    std::cout << "Sum, min, max, var of float column...";
+    start = std::chrono::high_resolution_clock::now();
+    float sum = df4.sum<1>();
+    float min = df4.min<1>();
+    float max = df4.max<1>();
+    double var = df4.var<1>();
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms (" << sum << ", " << min
+              << ", " << max << ", " << var << ")\n";
+
+    std::cout << "Filter float column against a double constant...";
+    start = std::chrono::high_resolution_clock::now();
+    std::size_t const selected = df4.filter<1>(df::le(0.1)).count();
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms ("
+              << (selected == static_cast<std::size_t>(std::ranges::count_if(
+                                  df4.column<1>(),
+                                  [](float x) { return x <= 0.1; }))
+                      ? "matching"
+                      : "NOT matching")
+              << ")\n";
+
+    std::cout << "Filter and compact rows...";
+    start = std::chrono::high_resolution_clock::now();
+    df4.compact(df4.filter<0>(df::ge(0)) & df4.filter<1>(df::lt(0.5f)));
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms (" << df4.size()
+              << " rows left)\n";
+
+    df::DataFrame<int, df::Nullable<float>> dfn;
+    dfn.reserve(NUM);
+    for (int i = 0; i < NUM; ++i) {
+      float const f = rf(mt);
+      if (f < -800'000.f) {
+        dfn.append(i, df::null);
+      } else {
+        dfn.append(i, f);
+      }
+    }
+    std::cout << "Sum, min, max, var of nullable float column...";
+    start = std::chrono::high_resolution_clock::now();
+    sum = dfn.sum<1>();
+    min = dfn.min<1>();
+    max = dfn.max<1>();
+    var = dfn.var<1>();
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms (" << sum << ", " << min
+              << ", " << max << ", " << var << ", " << dfn.nullCount<1>()
+              << " nulls)\n";
+
+    df::DataFrame<std::int64_t, int> dfp;
+    df::DataFrame<df::Delta<std::int64_t>, df::BitPacked<int>> dfe;
+    dfp.reserve(NUM);
+    dfe.reserve(NUM);
+    std::int64_t timestamp = 1'700'000'000'000;
+    for (int i = 0; i < NUM; ++i) {
+      timestamp += 1'000 + ri(mt) % 8;
+      int const id = ri(mt) % 1'000;
+      dfp.append(timestamp, id);
+      dfe.append(timestamp, id);
+    }
+    std::cout << "Delta and bit-packed columns use "
+              << dfe.byteSize<0>() + dfe.byteSize<1>() << " bytes instead of "
+              << dfp.byteSize<0>() + dfp.byteSize<1>() << "\n";
+    std::cout << "Sum, min, max of delta-encoded column...";
+    start = std::chrono::high_resolution_clock::now();
+    std::int64_t const tsum = dfe.sum<0>();
+    std::int64_t const tmin = dfe.min<0>();
+    std::int64_t const tmax = dfe.max<0>();
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms ("
+              << (tsum == dfp.sum<0>() && tmin == dfp.min<0>() &&
+                          tmax == dfp.max<0>()
+                      ? "matching"
+                      : "NOT matching")
+              << ")\n";
+    std::cout << "Filter bit-packed column...";
+    start = std::chrono::high_resolution_clock::now();
+    df::Mask const mask = dfe.filter<1>(df::ge(0));
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms ("
+              << (mask == dfp.filter<1>(df::ge(0)) ? "matching"
+                                                   : "NOT matching")
+              << ")\n";
     std::cout << "\n";
   }
 
@@ -290,17 +504,76 @@ int main(void) {
       fs.push_back(RandomString());
     }
 
-    std::cout << "Insertion by copy...";
+    std::cout << "Insertion by copy into a monotonic arena...";
     auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < NUM; ++i) {
-      df1.append(is[i], fs[i]);
+    auto end = start;
+    {
+      std::pmr::monotonic_buffer_resource arena;
+      df::DataFrame<std::pmr::string, std::pmr::string> df0{&arena};
+      // Monotonic resources do not reuse the buffers of grown columns.
+      df0.reserve(NUM);
+      for (int i = 0; i < NUM; ++i) {
+        df0.append(std::pmr::string{is[i], &arena},
+                   std::pmr::string{fs[i], &arena});
+      }
+      end = std::chrono::high_resolution_clock::now();
+      auto elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+              .count();
+      std::cout << " Elapsed time: " << elapsed << " ms\n";
+      std::cout << "Release of the arena...";
+      start = std::chrono::high_resolution_clock::now();
     }
-    auto end = std::chrono::high_resolution_clock::now();
+    end = std::chrono::high_resolution_clock::now();
     auto elapsed =
         std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
             .count();
     std::cout << " Elapsed time: " << elapsed << " ms\n";
 
+    {
+      df::DataFrame<df::str, df::str> dfs1;
+      std::cout << "Insertion by copy into contiguous str columns...";
+      start = std::chrono::high_resolution_clock::now();
+      for (int i = 0; i < NUM; ++i) {
+        dfs1.append(is[i], fs[i]);
+      }
+      end = std::chrono::high_resolution_clock::now();
+      elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+              .count();
+      std::cout << " Elapsed time: " << elapsed << " ms\n";
+
+      df::DataFrame<df::str, df::str> dfs2;
+      std::cout << "Append str columns by copy...";
+      start = std::chrono::high_resolution_clock::now();
+      dfs2.append(dfs1);
+      end = std::chrono::high_resolution_clock::now();
+      elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+              .count();
+      std::cout << " Elapsed time: " << elapsed << " ms\n";
+
+      df::DataFrame<df::str, df::str> dfs3;
+      std::cout << "Append str columns by move...";
+      start = std::chrono::high_resolution_clock::now();
+      dfs3.append(std::move(dfs1));
+      end = std::chrono::high_resolution_clock::now();
+      elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+              .count();
+      std::cout << " Elapsed time: " << elapsed << " ms\n";
+    }
+
+    std::cout << "Insertion by copy...";
+    start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < NUM; ++i) {
+      df1.append(is[i], fs[i]);
+    }
+    end = std::chrono::high_resolution_clock::now();
+    elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                  .count();
+    std::cout << " Elapsed time: " << elapsed << " ms\n";
+
     std::cout << "Insertion by move...";
     start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < NUM; ++i) {